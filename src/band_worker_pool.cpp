@@ -0,0 +1,97 @@
+// SPDX-FileCopyrightText: © 2026 Team CharLS
+// SPDX-License-Identifier: BSD-3-Clause
+
+module band_worker_pool;
+
+import std;
+
+namespace {
+
+// Decoding is usually memory bandwidth bound: more threads don't help, but would take cores from the host application.
+constexpr size_t max_thread_count{16};
+
+} // namespace
+
+
+band_worker_pool::band_worker_pool(const size_t thread_count) : max_queue_size_{thread_count * 2}
+{
+    try
+    {
+        threads_.reserve(thread_count);
+        for (size_t i{}; i != thread_count; ++i)
+        {
+            threads_.emplace_back([this] { run(); });
+        }
+    }
+    catch (...)
+    {
+        stop();
+        throw;
+    }
+}
+
+band_worker_pool::~band_worker_pool()
+{
+    stop();
+}
+
+size_t band_worker_pool::recommended_thread_count() noexcept
+{
+    // The calling thread performs the I/O, the worker threads the conversion.
+    const size_t hardware_thread_count{std::thread::hardware_concurrency()};
+    return std::min(hardware_thread_count > 1 ? hardware_thread_count - 1 : 0, max_thread_count);
+}
+
+void band_worker_pool::submit(work_item work)
+{
+    {
+        std::unique_lock lock{mutex_};
+        work_taken_or_done_.wait(lock, [this] { return queue_.size() < max_queue_size_; });
+        queue_.push_back(std::move(work));
+    }
+    work_available_.notify_one();
+}
+
+void band_worker_pool::wait()
+{
+    std::unique_lock lock{mutex_};
+    work_taken_or_done_.wait(lock, [this] { return queue_.empty() && active_count_ == 0; });
+}
+
+void band_worker_pool::stop() noexcept
+{
+    // Queued work is completed before the threads exit: it references the destination buffer of the caller.
+    {
+        std::scoped_lock lock{mutex_};
+        stopping_ = true;
+    }
+    work_available_.notify_all();
+    threads_.clear();
+}
+
+void band_worker_pool::run()
+{
+    for (;;)
+    {
+        work_item work;
+        {
+            std::unique_lock lock{mutex_};
+            work_available_.wait(lock, [this] { return stopping_ || !queue_.empty(); });
+            if (queue_.empty())
+                return;
+
+            work = std::move(queue_.front());
+            queue_.pop_front();
+            ++active_count_;
+        }
+        work_taken_or_done_.notify_all();
+
+        work();
+
+        {
+            std::scoped_lock lock{mutex_};
+            --active_count_;
+        }
+        work_taken_or_done_.notify_all();
+    }
+}
@@ -0,0 +1,44 @@
+// SPDX-FileCopyrightText: © 2026 Team CharLS
+// SPDX-License-Identifier: BSD-3-Clause
+
+export module band_worker_pool;
+
+import std;
+
+// Runs submitted work items (typically the conversion of a band of rows) on a fixed number of worker threads.
+// The queue is bounded: submit blocks while it is full, which also bounds the memory of in-flight work items.
+export class band_worker_pool final
+{
+public:
+    using work_item = std::move_only_function<void()>;
+
+    explicit band_worker_pool(size_t thread_count);
+    ~band_worker_pool();
+
+    band_worker_pool(const band_worker_pool&) = delete;
+    band_worker_pool(band_worker_pool&&) = delete;
+    band_worker_pool& operator=(const band_worker_pool&) = delete;
+    band_worker_pool& operator=(band_worker_pool&&) = delete;
+
+    // Returns the number of worker threads to use for a decode operation, 0 if the machine has only 1 core.
+    [[nodiscard]] static size_t recommended_thread_count() noexcept;
+
+    void submit(work_item work);
+
+    // Waits until all submitted work items are completed. Work can be submitted by more than 1 thread: the items of
+    // the other threads are waited for as well.
+    void wait();
+
+private:
+    void stop() noexcept;
+    void run();
+
+    size_t max_queue_size_;
+    std::mutex mutex_;
+    std::condition_variable work_available_;
+    std::condition_variable work_taken_or_done_;
+    std::deque<work_item> queue_;
+    size_t active_count_{};
+    bool stopping_{};
+    std::vector<std::jthread> threads_;
+};
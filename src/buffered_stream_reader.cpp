@@ -15,21 +15,55 @@ import "macros.hpp";
 
 using std::uint32_t;
 
-constexpr UINT MAX_BUFFER_SIZE = 65536;
+namespace {
 
+// Large enough for a header with a few comments: header-only readers (the property store, frame indexing) need 1 read.
+constexpr size_t initial_buffer_size{4 * 1024};
 
-buffered_stream_reader::buffered_stream_reader(_In_ IStream* stream) : buffer_(MAX_BUFFER_SIZE)
+// Every refill doubles the buffer until this size: long sequential reads need few IStream::Read calls.
+constexpr size_t max_buffer_size{4 * 1024 * 1024};
+
+// Pages of a memory mapped file are read when they are touched: an I/O error raises EXCEPTION_IN_PAGE_ERROR instead
+// of failing a read call. SEH cannot be mixed with C++ objects that need unwinding, hence the separate function.
+[[nodiscard]] bool try_copy_mapped_memory(void* destination, const void* source, const size_t size) noexcept
+{
+    __try
+    {
+        std::memcpy(destination, source, size);
+        return true;
+    }
+    __except (GetExceptionCode() == EXCEPTION_IN_PAGE_ERROR ? EXCEPTION_EXECUTE_HANDLER : EXCEPTION_CONTINUE_SEARCH)
+    {
+        return false;
+    }
+}
+
+} // namespace
+
+
+buffered_stream_reader::buffered_stream_reader(_In_ IStream* stream) : buffer_(initial_buffer_size)
 {
     ASSERT(stream);
 
     stream_.copy_from(stream);
 
-    // buffer_ = new BYTE[MAX_BUFFER_SIZE];
-
     unsigned long read;
-    check_hresult(stream->Read(buffer_.data(), MAX_BUFFER_SIZE, &read), wincodec::error_stream_read);
+    check_hresult(stream->Read(buffer_.data(), static_cast<ULONG>(buffer_.size()), &read), wincodec::error_stream_read);
 
+    data_ = buffer_.data();
     buffer_size_ = read;
+    stream_position_ = read;
+}
+
+buffered_stream_reader::buffered_stream_reader(_In_ IStream* stream, std::unique_lock<std::mutex> stream_lock) :
+    buffered_stream_reader{stream}
+{
+    stream_lock_ = std::move(stream_lock);
+}
+
+buffered_stream_reader::buffered_stream_reader(const std::span<const std::byte> data) noexcept :
+    data_{reinterpret_cast<const BYTE*>(data.data())}, buffer_size_{data.size()}, stream_position_{data.size()}
+{
 }
 
 uint32_t buffered_stream_reader::read_int()
@@ -58,18 +92,13 @@ char buffered_stream_reader::read_char()
 {
     if (position_ + sizeof(char) > buffer_size_)
     {
-        if (buffer_size_ == MAX_BUFFER_SIZE)
-        {
-            RefillBuffer();
+        RefillBuffer();
 
-            if (buffer_size_ < sizeof(char))
-                winrt::throw_hresult(wincodec::error_bad_header);
-        }
-        else
+        if (position_ + sizeof(char) > buffer_size_)
             winrt::throw_hresult(wincodec::error_bad_header);
     }
 
-    const char result = buffer_[position_];
+    const char result = static_cast<char>(data_[position_]);
 
     position_ += sizeof(char);
 
@@ -123,23 +152,60 @@ void buffered_stream_reader::read_string(char* str, const ULONG maxCount)
 }
 
 void buffered_stream_reader::read_bytes(void* buffer, size_t size)
+{
+    if (row_gap_ == 0)
+    {
+        read_contiguous_bytes(buffer, size);
+        return;
+    }
+
+    // The gap is skipped when the next row is needed: the reader never moves beyond the last row of the region.
+    auto* destination{static_cast<std::byte*>(buffer)};
+    while (size != 0)
+    {
+        if (remaining_in_row_ == 0)
+        {
+            skip(row_gap_);
+            remaining_in_row_ = row_size_;
+        }
+
+        const size_t count{std::min(size, remaining_in_row_)};
+        read_contiguous_bytes(destination, count);
+        remaining_in_row_ -= count;
+        destination += count;
+        size -= count;
+    }
+}
+
+void buffered_stream_reader::read_contiguous_bytes(void* buffer, size_t size)
 {
     const size_t remaining_in_buffer = buffer_size_ - position_;
 
     if (remaining_in_buffer >= size)
     {
-        memcpy(buffer, buffer_.data() + position_, size);
+        copy_buffered_data(buffer, size);
         position_ += static_cast<UINT>(size);
         return;
     }
 
-    memcpy(buffer, buffer_.data() + position_, remaining_in_buffer);
+    if (!stream_)
+        winrt::throw_hresult(wincodec::error_stream_read);
+
+    memcpy(buffer, data_ + position_, remaining_in_buffer);
     position_ += static_cast<UINT>(remaining_in_buffer);
     size -= remaining_in_buffer;
 
-    unsigned long read;
-    check_hresult(stream_->Read(static_cast<std::byte*>(buffer) + remaining_in_buffer, static_cast<ULONG>(size), &read),
-                  wincodec::error_stream_read);
+    // The data is read directly into the buffer of the caller: a stream that ends early may not leave a part of it
+    // uninitialized. Streams may return less than requested before the end, only an empty read is the end.
+    auto* destination{static_cast<std::byte*>(buffer) + remaining_in_buffer};
+    while (size != 0)
+    {
+        const size_t read{read_from_stream(destination, size)};
+        check_condition(read != 0, wincodec::error_stream_read);
+        stream_position_ += read;
+        destination += read;
+        size -= read;
+    }
 }
 
 void buffered_stream_reader::read_bytes(void* buf, const ULONG count, ULONG* bytesRead)
@@ -151,20 +217,20 @@ void buffered_stream_reader::read_bytes(void* buf, const ULONG count, ULONG* byt
     {
         if (buffer_size_ - position_ >= remaining)
         {
-            memcpy(b, buffer_.data() + position_, remaining);
+            copy_buffered_data(b, remaining);
             position_ += remaining;
             *bytesRead = count;
             return;
         }
 
-        memcpy(b, buffer_.data() + position_, buffer_size_ - position_);
+        copy_buffered_data(b, buffer_size_ - position_);
         b += buffer_size_ - position_;
         remaining -= static_cast<ULONG>(buffer_size_ - position_);
         position_ = buffer_size_;
 
         RefillBuffer();
 
-        if (buffer_size_ == 0)
+        if (position_ == buffer_size_)
         {
             *bytesRead = count - remaining;
             return;
@@ -172,16 +238,142 @@ void buffered_stream_reader::read_bytes(void* buf, const ULONG count, ULONG* byt
     }
 }
 
+void buffered_stream_reader::skip(const size_t count)
+{
+    const size_t remaining_in_buffer = buffer_size_ - position_;
+
+    if (remaining_in_buffer >= count)
+    {
+        position_ += count;
+        return;
+    }
+
+    if (!stream_)
+        winrt::throw_hresult(wincodec::error_stream_read);
+
+    // Skip the remainder directly in the stream and discard the buffered data.
+    if (prefetcher_)
+    {
+        check_condition(prefetcher_->skip(count - remaining_in_buffer) == count - remaining_in_buffer,
+                        wincodec::error_stream_read);
+    }
+    else
+    {
+        LARGE_INTEGER offset;
+        offset.QuadPart = static_cast<LONGLONG>(count - remaining_in_buffer);
+        check_hresult(stream_->Seek(offset, STREAM_SEEK_CUR, nullptr), wincodec::error_stream_read);
+    }
+
+    stream_position_ += count - remaining_in_buffer;
+    buffer_size_ = 0;
+    position_ = 0;
+}
+
+void buffered_stream_reader::set_row_gap(const size_t row_size, const size_t gap) noexcept
+{
+    row_size_ = row_size;
+    row_gap_ = gap;
+    remaining_in_row_ = row_size;
+}
+
+bool buffered_stream_reader::fill_buffer()
+{
+    const size_t remaining_in_buffer = buffer_size_ - position_;
+    RefillBuffer();
+    return buffer_size_ - position_ != remaining_in_buffer;
+}
+
 void buffered_stream_reader::RefillBuffer()
 {
-    memcpy(buffer_.data(), buffer_.data() + position_, buffer_size_ - position_);
+    // All data is already available when reading from memory.
+    if (!stream_)
+        return;
 
-    position_ = buffer_size_ - position_;
+    const size_t remaining_in_buffer = buffer_size_ - position_;
+    memmove(buffer_.data(), data_ + position_, remaining_in_buffer);
+    grow_buffer(remaining_in_buffer);
 
-    unsigned long read;
-    check_hresult(stream_->Read(buffer_.data() + position_, static_cast<ULONG>(buffer_size_ - position_), &read),
-                  wincodec::error_stream_read);
+    const size_t read{read_from_stream(buffer_.data() + remaining_in_buffer, buffer_.size() - remaining_in_buffer)};
 
-    buffer_size_ = position_ + read;
+    buffer_size_ = remaining_in_buffer + read;
     position_ = 0;
+    stream_position_ += read;
+}
+
+void buffered_stream_reader::grow_buffer(const size_t remaining_in_buffer)
+{
+    if (buffer_.size() == max_buffer_size)
+        return;
+
+    // The remaining size of the stream is only needed (and queried) when the reader keeps reading.
+    if (!stream_end_)
+    {
+        stream_end_ = std::numeric_limits<std::uint64_t>::max();
+
+        STATSTG stat;
+        ULARGE_INTEGER stream_position;
+        if (SUCCEEDED(stream_->Stat(&stat, STATFLAG_NONAME)) &&
+            SUCCEEDED(stream_->Seek({}, STREAM_SEEK_CUR, &stream_position)) &&
+            stat.cbSize.QuadPart >= stream_position.QuadPart)
+        {
+            stream_end_ = stream_position_ + (stat.cbSize.QuadPart - stream_position.QuadPart);
+        }
+    }
+
+    // A buffer larger than the remaining data would only waste memory.
+    const std::uint64_t required_size{remaining_in_buffer + (*stream_end_ - std::min(stream_position_, *stream_end_))};
+    const size_t new_size{static_cast<size_t>(
+        std::min({std::uint64_t{buffer_.size() * 2}, std::uint64_t{max_buffer_size}, required_size}))};
+    if (new_size > buffer_.size())
+    {
+        buffer_.resize(new_size);
+        data_ = buffer_.data();
+    }
+}
+
+void buffered_stream_reader::start_read_ahead(const std::uint64_t size)
+{
+    const size_t remaining_in_buffer = buffer_size_ - position_;
+    if (!stream_)
+    {
+        // Memory (a mapped file) is paged in by the OS: ask it to read the pages with large I/O requests up front,
+        // instead of 1 page fault at a time.
+        WIN32_MEMORY_RANGE_ENTRY range{const_cast<BYTE*>(data_ + position_),
+                                       static_cast<size_t>(std::min(size, std::uint64_t{remaining_in_buffer}))};
+        if (range.NumberOfBytes != 0)
+        {
+            std::ignore = PrefetchVirtualMemory(GetCurrentProcess(), 1, &range, 0);
+        }
+        return;
+    }
+
+    // The prefetcher reads from another thread: streams that are bound to their apartment are read directly.
+    if (prefetcher_ || size <= remaining_in_buffer || !is_free_threaded(stream_.get()))
+        return;
+
+    prefetcher_ = std::make_unique<stream_prefetcher>(stream_.get(), size - remaining_in_buffer);
+
+    // The stream may not be used while it is prefetched, the end of the data is known.
+    stream_end_ = stream_position_ + (size - remaining_in_buffer);
+}
+
+void buffered_stream_reader::copy_buffered_data(void* destination, const size_t size) const
+{
+    if (stream_)
+    {
+        memcpy(destination, data_ + position_, size);
+        return;
+    }
+
+    check_condition(try_copy_mapped_memory(destination, data_ + position_, size), wincodec::error_stream_read);
+}
+
+size_t buffered_stream_reader::read_from_stream(void* buffer, const size_t size)
+{
+    if (prefetcher_)
+        return prefetcher_->read(static_cast<std::byte*>(buffer), size);
+
+    unsigned long read;
+    check_hresult(stream_->Read(buffer, static_cast<ULONG>(size), &read), wincodec::error_stream_read);
+    return read;
 }
@@ -11,32 +11,79 @@ import <win.hpp>;
 import std;
 import winrt_base;
 
+import stream_prefetcher;
+
 export class buffered_stream_reader final
 {
 public:
     explicit buffered_stream_reader(_In_ IStream* stream);
 
+    // Keeps the lock that grants exclusive use of the stream until the reader (and its read-ahead) is destroyed.
+    buffered_stream_reader(_In_ IStream* stream, std::unique_lock<std::mutex> stream_lock);
+
+    // Reads directly from memory (for example a memory mapped file), no data is copied into an internal buffer.
+    explicit buffered_stream_reader(std::span<const std::byte> data) noexcept;
+
     [[nodiscard]] std::uint32_t read_int();
     [[nodiscard]] bool try_read_bytes(void* buffer, size_t size);
     void read_bytes(void* buffer, size_t size);
+    void read_bytes(void* buf, ULONG count, ULONG* bytesRead);
+    void read_string(char* str, ULONG maxCount);
+    void skip(size_t count);
 
-    [[nodiscard]] std::vector<std::byte> read_bytes(const size_t size)
+    // From the next read on, read_bytes(buffer, size) skips gap bytes after every row_size bytes: the columns outside
+    // a region are skipped and the rows of the region are read packed. The gap after the last row is never read.
+    void set_row_gap(size_t row_size, size_t gap) noexcept;
+
+    // Reads the next size bytes (including the buffered data) ahead on a background thread, for large sequential reads.
+    // The reader may not seek afterwards: skipped data is read and discarded. When reading from memory, the OS is
+    // asked to page in the data.
+    void start_read_ahead(std::uint64_t size);
+
+    // Direct access to the buffered data, for parsers that process complete blocks of data.
+    [[nodiscard]] std::span<const std::byte> buffered_data() const noexcept
     {
-        std::vector<std::byte> bytes(size);
-        read_bytes(bytes.data(), bytes.size());
-        return bytes;
+        return {reinterpret_cast<const std::byte*>(data_ + position_), buffer_size_ - position_};
     }
 
-    void read_bytes(void* buf, ULONG count, ULONG* bytesRead);
-    void read_string(char* str, ULONG maxCount);
+    void consume(const size_t count) noexcept
+    {
+        position_ += count;
+    }
+
+    // Moves the remaining data to the start of the buffer and reads more data, returns false at the end of the stream.
+    [[nodiscard]] bool fill_buffer();
+
+    // True when the data is read from memory: every read is a memcpy, there are no IStream::Read calls to save.
+    [[nodiscard]] bool is_memory_backed() const noexcept
+    {
+        return !stream_;
+    }
+
+    [[nodiscard]] std::uint64_t position() const noexcept
+    {
+        return stream_position_ - (buffer_size_ - position_);
+    }
 
 private:
     char read_char();
     void skip_line();
     void RefillBuffer();
+    void grow_buffer(size_t remaining_in_buffer);
+    void read_contiguous_bytes(void* buffer, size_t size);
+    void copy_buffered_data(void* destination, size_t size) const;
+    [[nodiscard]] size_t read_from_stream(void* buffer, size_t size);
 
+    std::unique_lock<std::mutex> stream_lock_;
     winrt::com_ptr<IStream> stream_;
     std::vector<BYTE> buffer_;
+    const BYTE* data_{};
     size_t buffer_size_{};
     size_t position_{};
+    std::uint64_t stream_position_{};
+    std::optional<std::uint64_t> stream_end_;
+    std::unique_ptr<stream_prefetcher> prefetcher_;
+    size_t row_size_{};
+    size_t row_gap_{};
+    size_t remaining_in_row_{};
 };
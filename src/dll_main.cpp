@@ -15,6 +15,7 @@ import guids;
 import registry;
 import util;
 import property_store;
+import sample_conversion;
 import "macros.hpp";
 
 using std::array;
@@ -24,8 +25,9 @@ using namespace std::string_literals;
 
 namespace {
 
-constexpr wchar_t mime_types[]{L"image/x-portable-graymap,image/x-portable-pixmap,image/x-portable-arbitrarymap"};
-constexpr wchar_t file_extensions[]{L".pgm,.ppm,.pam"};
+constexpr wchar_t mime_types[]{L"image/x-portable-bitmap,image/x-portable-graymap,image/x-portable-pixmap,"
+                               L"image/x-portable-arbitrarymap,image/x-portable-floatmap"};
+constexpr wchar_t file_extensions[]{L".pbm,.pgm,.ppm,.pam,.pfm"};
 
 void register_general_decoder_settings(const GUID& class_id, const GUID& wic_category_id, const wchar_t* friendly_name,
                                        const std::span<const GUID*> formats)
@@ -103,8 +105,10 @@ void register_decoder_pattern(const wstring& sub_key, const int index, const std
 
 void register_decoder()
 {
-    array formats{&GUID_WICPixelFormat2bppGray, &GUID_WICPixelFormat4bppGray, &GUID_WICPixelFormat8bppGray,
-                  &GUID_WICPixelFormat16bppGray, &GUID_WICPixelFormat24bppRGB, &GUID_WICPixelFormat32bppRGBA};
+    array formats{&GUID_WICPixelFormatBlackWhite,      &GUID_WICPixelFormat2bppGray,      &GUID_WICPixelFormat4bppGray,
+                  &GUID_WICPixelFormat8bppGray,       &GUID_WICPixelFormat16bppGray,     &GUID_WICPixelFormat24bppRGB,
+                  &GUID_WICPixelFormat48bppRGB,       &GUID_WICPixelFormat32bppRGBA,     &GUID_WICPixelFormat64bppRGBA,
+                  &GUID_WICPixelFormat32bppGrayFloat, &GUID_WICPixelFormat96bppRGBFloat};
     register_general_decoder_settings(id::netpbm_decoder, CATID_WICBitmapDecoders, L"Team CharLS Netpbm Decoder", formats);
 
     const wstring sub_key{LR"(SOFTWARE\Classes\CLSID\)" + guid_to_string(id::netpbm_decoder)};
@@ -113,10 +117,18 @@ void register_decoder()
     register_decoder_pattern(sub_key, 0, array{std::byte{0x50}, std::byte{0x35}});
     register_decoder_pattern(sub_key, 1, array{std::byte{0x50}, std::byte{0x36}});
     register_decoder_pattern(sub_key, 2, array{std::byte{0x50}, std::byte{0x37}});
-
+    register_decoder_pattern(sub_key, 3, array{std::byte{0x50}, std::byte{0x32}});
+    register_decoder_pattern(sub_key, 4, array{std::byte{0x50}, std::byte{0x33}});
+    register_decoder_pattern(sub_key, 5, array{std::byte{0x50}, std::byte{0x31}});
+    register_decoder_pattern(sub_key, 6, array{std::byte{0x50}, std::byte{0x34}});
+    register_decoder_pattern(sub_key, 7, array{std::byte{0x50}, std::byte{0x46}});
+    register_decoder_pattern(sub_key, 8, array{std::byte{0x50}, std::byte{0x66}});
+
+    register_decoder_file_extension(L"pbmfile", L".pbm", L"image/x-portable-bitmap");
     register_decoder_file_extension(L"pgmfile", L".pgm", L"image/x-portable-graymap");
     register_decoder_file_extension(L"ppmfile", L".ppm", L"image/x-portable-pixmap");
     register_decoder_file_extension(L"pamfile", L".pam", L"image/x-portable-arbitrarymap");
+    register_decoder_file_extension(L"pfmfile", L".pfm", L"image/x-portable-floatmap");
 }
 
 void register_property_store_file_extension(const wchar_t* file_extension)
@@ -148,9 +160,11 @@ void register_property_store()
     registry::set_value(inproc_server_sub_key, L"", get_module_path().c_str());
     registry::set_value(inproc_server_sub_key, L"ThreadingModel", L"Both");
 
+    register_property_store_file_extension(L".pbm");
     register_property_store_file_extension(L".pgm");
     register_property_store_file_extension(L".ppm");
     register_property_store_file_extension(L".pam");
+    register_property_store_file_extension(L".pfm");
 }
 
 [[nodiscard]] HRESULT unregister(const GUID& class_id, const GUID& wic_category_id)
@@ -177,6 +191,7 @@ BOOL __stdcall DllMain(const HMODULE dll_module, const DWORD reason_for_call, vo
     case DLL_PROCESS_ATTACH:
         TRACE("netpbm-wic-codec::DllMain DLL_PROCESS_ATTACH \n");
         VERIFY(DisableThreadLibraryCalls(dll_module));
+        initialize_sample_conversion();
         break;
 
     case DLL_THREAD_ATTACH:
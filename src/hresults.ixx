@@ -42,6 +42,7 @@ constexpr HRESULT error_codec_too_many_scan_lines{WINCODEC_ERR_CODECTOOMANYSCANL
 constexpr HRESULT error_component_not_found{WINCODEC_ERR_COMPONENTNOTFOUND};
 constexpr HRESULT error_bad_header{WINCODEC_ERR_BADHEADER};
 constexpr HRESULT error_bad_image{WINCODEC_ERR_BADIMAGE};
+constexpr HRESULT error_insufficient_buffer{WINCODEC_ERR_INSUFFICIENTBUFFER};
 constexpr HRESULT error_stream_not_available{WINCODEC_ERR_STREAMNOTAVAILABLE};
 constexpr HRESULT error_stream_read{WINCODEC_ERR_STREAMREAD};
 
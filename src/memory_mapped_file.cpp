@@ -0,0 +1,129 @@
+// SPDX-FileCopyrightText: © 2026 Team CharLS
+// SPDX-License-Identifier: BSD-3-Clause
+
+module;
+
+#include "intellisense.hpp"
+
+module memory_mapped_file;
+
+import <win.hpp>;
+import std;
+import winrt_base;
+
+namespace {
+
+struct co_task_mem_deleter final
+{
+    void operator()(wchar_t* memory) const noexcept
+    {
+        CoTaskMemFree(memory);
+    }
+};
+
+[[nodiscard]] bool is_remote_file(const HANDLE file) noexcept
+{
+    // Pages of a view on a network file can become unavailable, which would fail with an access violation.
+    FILE_REMOTE_PROTOCOL_INFO remote_protocol_info;
+    return GetFileInformationByHandleEx(file, FileRemoteProtocolInfo, &remote_protocol_info,
+                                        sizeof remote_protocol_info) != 0;
+}
+
+[[nodiscard]] bool is_absolute_path(_Null_terminated_ const wchar_t* name) noexcept
+{
+    // A relative name (or the name of a storage element) would be resolved against the current directory.
+    return (std::iswalpha(name[0]) && name[1] == L':' && (name[2] == L'\\' || name[2] == L'/')) ||
+           (name[0] == L'\\' && name[1] == L'\\');
+}
+
+[[nodiscard]] bool is_same_file(const HANDLE file, const STATSTG& stat) noexcept
+{
+    // The stream only reports its name, size and times. A different file, or a file that was replaced or modified
+    // after the stream was opened, has a different size, creation time or last write time.
+    BY_HANDLE_FILE_INFORMATION information;
+    return GetFileInformationByHandle(file, &information) &&
+           (std::uint64_t{information.nFileSizeHigh} << 32 | information.nFileSizeLow) == stat.cbSize.QuadPart &&
+           CompareFileTime(&information.ftCreationTime, &stat.ctime) == 0 &&
+           CompareFileTime(&information.ftLastWriteTime, &stat.mtime) == 0;
+}
+
+[[nodiscard]] bool is_removable_media_file(_Null_terminated_ const wchar_t* name) noexcept
+{
+    // Removable media can be ejected while the view is read. A volume that cannot be determined is treated the same.
+    std::array<wchar_t, MAX_PATH + 1> volume_path;
+    if (!GetVolumePathNameW(name, volume_path.data(), static_cast<DWORD>(volume_path.size())))
+        return true;
+
+    const UINT drive_type{GetDriveTypeW(volume_path.data())};
+    return drive_type == DRIVE_REMOVABLE || drive_type == DRIVE_CDROM;
+}
+
+} // namespace
+
+
+memory_mapped_file::memory_mapped_file(const std::byte* view, const size_t size) noexcept : view_{view}, size_{size}
+{
+}
+
+memory_mapped_file::~memory_mapped_file()
+{
+    if (view_)
+    {
+        UnmapViewOfFile(view_);
+    }
+}
+
+memory_mapped_file::memory_mapped_file(memory_mapped_file&& other) noexcept :
+    view_{std::exchange(other.view_, nullptr)}, size_{std::exchange(other.size_, 0)}
+{
+}
+
+memory_mapped_file& memory_mapped_file::operator=(memory_mapped_file&& other) noexcept
+{
+    if (this != &other)
+    {
+        if (view_)
+        {
+            UnmapViewOfFile(view_);
+        }
+
+        view_ = std::exchange(other.view_, nullptr);
+        size_ = std::exchange(other.size_, 0);
+    }
+
+    return *this;
+}
+
+memory_mapped_file memory_mapped_file::try_map(_In_ IStream* stream) noexcept
+{
+    // File streams (SHCreateStreamOnFile, IWICStream::InitializeFromFilename) report the path of the file.
+    STATSTG stat{};
+    if (FAILED(stream->Stat(&stat, STATFLAG_DEFAULT)))
+        return {};
+
+    const std::unique_ptr<wchar_t, co_task_mem_deleter> name{stat.pwcsName};
+    if (!name || stat.cbSize.QuadPart == 0 || stat.cbSize.QuadPart > std::numeric_limits<size_t>::max())
+        return {};
+
+    if (stat.type != STGTY_STREAM || !is_absolute_path(name.get()) || is_removable_media_file(name.get()))
+        return {};
+
+    const winrt::file_handle file{CreateFileW(name.get(), GENERIC_READ, FILE_SHARE_READ | FILE_SHARE_DELETE, nullptr,
+                                              OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr)};
+    if (!file || is_remote_file(file.get()))
+        return {};
+
+    // Only the file of the stream may replace it. The mapping is created from the handle that is verified.
+    if (!is_same_file(file.get(), stat))
+        return {};
+
+    const winrt::handle mapping{CreateFileMappingW(file.get(), nullptr, PAGE_READONLY, 0, 0, nullptr)};
+    if (!mapping)
+        return {};
+
+    const auto* view{static_cast<const std::byte*>(MapViewOfFile(mapping.get(), FILE_MAP_READ, 0, 0, 0))};
+    if (!view)
+        return {};
+
+    return {view, static_cast<size_t>(stat.cbSize.QuadPart)};
+}
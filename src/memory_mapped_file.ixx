@@ -0,0 +1,44 @@
+// SPDX-FileCopyrightText: © 2026 Team CharLS
+// SPDX-License-Identifier: BSD-3-Clause
+
+module;
+
+#include "intellisense.hpp"
+
+export module memory_mapped_file;
+
+import <win.hpp>;
+import std;
+
+// Read-only view of the local file that backs a stream. Reading from the view avoids copying the file data
+// through IStream::Read and shares the pages of the OS file cache with other readers of the file.
+export class memory_mapped_file final
+{
+public:
+    memory_mapped_file() = default;
+    ~memory_mapped_file();
+
+    memory_mapped_file(const memory_mapped_file&) = delete;
+    memory_mapped_file(memory_mapped_file&& other) noexcept;
+    memory_mapped_file& operator=(const memory_mapped_file&) = delete;
+    memory_mapped_file& operator=(memory_mapped_file&& other) noexcept;
+
+    // Returns an empty object when the stream is not backed by a local file, the stream should be used directly.
+    [[nodiscard]] static memory_mapped_file try_map(_In_ IStream* stream) noexcept;
+
+    [[nodiscard]] std::span<const std::byte> data() const noexcept
+    {
+        return {view_, size_};
+    }
+
+    [[nodiscard]] bool empty() const noexcept
+    {
+        return view_ == nullptr;
+    }
+
+private:
+    memory_mapped_file(const std::byte* view, size_t size) noexcept;
+
+    const std::byte* view_{};
+    size_t size_{};
+};
@@ -11,6 +11,7 @@ import std;
 import winrt_base;
 import <win.hpp>;
 
+import buffered_stream_reader;
 import class_factory;
 import hresults;
 import pnm_header;
@@ -59,8 +60,7 @@ struct netpbm_bitmap_decoder : winrt::implements<netpbm_bitmap_decoder, IWICBitm
         return to_hresult();
     }
 
-    HRESULT __stdcall Initialize(_In_ IStream* stream,
-                                 [[maybe_unused]] const WICDecodeOptions cache_options) noexcept override
+    HRESULT __stdcall Initialize(_In_ IStream* stream, const WICDecodeOptions cache_options) noexcept override
     try
     {
         TRACE("{} netpbm_bitmap_decoder::Initialize, stream address={}, cache_options={}\n", fmt_ptr(this), fmt_ptr(stream),
@@ -68,7 +68,24 @@ struct netpbm_bitmap_decoder : winrt::implements<netpbm_bitmap_decoder, IWICBitm
 
         scoped_lock lock{mutex_};
         source_stream_.copy_from(check_in_pointer(stream));
-        bitmap_frame_decode_.attach(nullptr);
+        stream_mutex_ = std::make_shared<std::mutex>();
+        first_frame_.store(nullptr, std::memory_order_release);
+        frames_.clear();
+        all_frames_indexed_ = false;
+
+        ULARGE_INTEGER start_position;
+        {
+            scoped_lock stream_lock{*stream_mutex_};
+            check_hresult(source_stream_->Seek({}, STREAM_SEEK_CUR, &start_position));
+        }
+        start_position_ = start_position.QuadPart;
+
+        // The header is the only metadata of a Netpbm file. Pixels are always decoded on demand by CopyPixels.
+        if (cache_options == WICDecodeMetadataCacheOnLoad)
+        {
+            index_frames(1);
+            std::ignore = first_frame();
+        }
 
         return success_ok;
     }
@@ -166,10 +183,20 @@ struct netpbm_bitmap_decoder : winrt::implements<netpbm_bitmap_decoder, IWICBitm
     HRESULT __stdcall GetFrameCount(_Out_ uint32_t* count) noexcept override
     try
     {
-        TRACE("{} netpbm_bitmap_decoder::GetFrameCount (always 1), count address={}\n", fmt_ptr(this), fmt_ptr(count));
+        TRACE("{} netpbm_bitmap_decoder::GetFrameCount, count address={}\n", fmt_ptr(this), fmt_ptr(count));
+
+        check_out_pointer(count);
+
+        scoped_lock lock{mutex_};
+        if (!source_stream_)
+        {
+            // Keep the behavior of a decoder without a stream: it reports the single frame of a regular Netpbm file.
+            *count = 1;
+            return success_ok;
+        }
 
-        // Only 1 frame is supported by this implementation (no real world samples are known that have more)
-        *check_out_pointer(count) = 1;
+        // Only the headers are read to build the frame index, the pixel data of every frame is skipped.
+        *count = static_cast<uint32_t>(index_frames(std::numeric_limits<size_t>::max()));
         return success_ok;
     }
     catch (...)
@@ -183,17 +210,28 @@ struct netpbm_bitmap_decoder : winrt::implements<netpbm_bitmap_decoder, IWICBitm
         TRACE("{} netpbm_bitmap_decoder::GetFrame, index={}, bitmap_frame_decode address={}\n", fmt_ptr(this), index,
               fmt_ptr(bitmap_frame_decode));
 
-        check_condition(index == 0, wincodec::error_frame_missing);
+        // Once created, the first frame is returned without the lock. Concurrent first calls wait for 1 of them.
+        if (index == 0)
+        {
+            if (const auto frame{first_frame_.load(std::memory_order_acquire)})
+            {
+                frame->copy_to(check_out_pointer(bitmap_frame_decode));
+                return success_ok;
+            }
+        }
 
         scoped_lock lock{mutex_};
         check_condition(static_cast<bool>(source_stream_), wincodec::error_not_initialized);
+        check_condition(index < index_frames(static_cast<size_t>(index) + 1), wincodec::error_frame_missing);
 
-        if (!bitmap_frame_decode_)
+        // The first frame is cached, it is the only frame for almost all Netpbm files.
+        if (index != 0)
         {
-            bitmap_frame_decode_ = winrt::make<netpbm_bitmap_frame_decode>(source_stream_.get(), imaging_factory());
+            create_frame_decode(index).copy_to(check_out_pointer(bitmap_frame_decode));
+            return success_ok;
         }
 
-        bitmap_frame_decode_.copy_to(check_out_pointer(bitmap_frame_decode));
+        first_frame()->copy_to(check_out_pointer(bitmap_frame_decode));
         return success_ok;
     }
     catch (...)
@@ -202,21 +240,93 @@ struct netpbm_bitmap_decoder : winrt::implements<netpbm_bitmap_decoder, IWICBitm
     }
 
 private:
-    IWICImagingFactory* imaging_factory()
+    struct frame_info
     {
-        if (!imaging_factory_)
+        pnm_header header;
+        std::uint64_t pixel_data_position;
+    };
+
+    [[nodiscard]] com_ptr<IWICBitmapFrameDecode> create_frame_decode(const uint32_t index) const
+    {
+        const auto& [header, pixel_data_position]{frames_[index]};
+        return winrt::make<netpbm_bitmap_frame_decode>(source_stream_.get(), stream_mutex_, imaging_factory_,
+                                                       header, pixel_data_position);
+    }
+
+    // Creates the first frame once per Initialize call, the caller must hold the lock.
+    [[nodiscard]] std::shared_ptr<const com_ptr<IWICBitmapFrameDecode>> first_frame()
+    {
+        auto frame{first_frame_.load(std::memory_order_relaxed)};
+        if (!frame)
         {
-            check_hresult(CoCreateInstance(CLSID_WICImagingFactory, nullptr, CLSCTX_INPROC_SERVER,
-                                           IID_PPV_ARGS(imaging_factory_.put())));
+            frame = std::make_shared<const com_ptr<IWICBitmapFrameDecode>>(create_frame_decode(0));
+            first_frame_.store(frame, std::memory_order_release);
         }
 
-        return imaging_factory_.get();
+        return frame;
+    }
+
+    // Extends the frame index until it contains count frames or the end of the stream is reached.
+    // Binary images are stored back to back without padding: the next header starts directly after the fixed
+    // size raster of the previous image. ASCII images can only be the last image in a stream.
+    // The frames decode from the same stream: it is locked while the headers are read.
+    size_t index_frames(const size_t count)
+    {
+        while (frames_.size() < count && !all_frames_indexed_)
+        {
+            scoped_lock stream_lock{*stream_mutex_};
+            std::uint64_t frame_position{start_position_};
+            if (!frames_.empty())
+            {
+                const auto& [header, pixel_data_position]{frames_.back()};
+                frame_position = pixel_data_position + header.raster_size();
+                if (header.AsciiFormat || !is_pnm_file_at(frame_position))
+                {
+                    all_frames_indexed_ = true;
+                    break;
+                }
+            }
+
+            seek(frame_position);
+
+            // Only parse the header, the pixel data is not touched until CopyPixels is called.
+            buffered_stream_reader stream_reader{source_stream_.get()};
+            const pnm_header header{stream_reader};
+            frames_.push_back({header, frame_position + stream_reader.position()});
+        }
+
+        return frames_.size();
+    }
+
+    [[nodiscard]] bool is_pnm_file_at(const std::uint64_t position) const
+    {
+        seek(position);
+        return is_pnm_file(source_stream_.get());
+    }
+
+    void seek(const std::uint64_t position) const
+    {
+        LARGE_INTEGER offset;
+        offset.QuadPart = static_cast<LONGLONG>(position);
+        check_hresult(source_stream_->Seek(offset, STREAM_SEEK_SET, nullptr));
+    }
+
+    IWICImagingFactory* imaging_factory()
+    {
+        return imaging_factory_->get();
     }
 
     std::mutex mutex_;
-    com_ptr<IWICImagingFactory> imaging_factory_;
+    std::shared_ptr<imaging_factory_cache> imaging_factory_{std::make_shared<imaging_factory_cache>()};
     com_ptr<IStream> source_stream_;
-    com_ptr<IWICBitmapFrameDecode> bitmap_frame_decode_;
+    std::shared_ptr<std::mutex> stream_mutex_; // Shared with the frames, locked while source_stream_ is used.
+    std::uint64_t start_position_{};
+    std::vector<frame_info> frames_;
+    bool all_frames_indexed_{};
+
+    // The first frame is read without the lock. A reader that loaded it shares ownership: the frame of a previous
+    // Initialize call stays alive until that reader has copied it.
+    std::atomic<std::shared_ptr<const com_ptr<IWICBitmapFrameDecode>>> first_frame_;
 };
 
 } // namespace
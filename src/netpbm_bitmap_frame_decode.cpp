@@ -12,17 +12,20 @@ import winrt_base;
 import <win.hpp>;
 
 import hresults;
+import band_worker_pool;
 import buffered_stream_reader;
+import memory_mapped_file;
+import pixel_transform;
 import pnm_header;
+import sample_conversion;
 import util;
 import "macros.hpp";
 
-using std::byteswap;
 using std::int32_t;
+using std::ptrdiff_t;
 using std::span;
 using std::uint16_t;
 using std::uint32_t;
-using std::ranges::transform;
 using winrt::check_hresult;
 using winrt::com_ptr;
 using winrt::throw_hresult;
@@ -34,7 +37,7 @@ namespace {
     switch (type)
     {
     case PnmType::Bitmap:
-        break;
+        return {GUID_WICPixelFormatBlackWhite, 0};
 
     case PnmType::Graymap:
         switch (bits_per_sample)
@@ -75,6 +78,8 @@ namespace {
         {
         case 8:
             return {GUID_WICPixelFormat32bppRGBA, 0};
+        case 16:
+            return {GUID_WICPixelFormat64bppRGBA, 0};
         default:
             break;
         }
@@ -84,355 +89,1773 @@ namespace {
     throw_hresult(wincodec::error_unsupported_pixel_format);
 }
 
-constexpr void convert_to_little_endian(span<uint16_t> samples) noexcept
+// Returns the bits per sample of the WIC pixel format. Samples with a maximum value that doesn't match a WIC pixel
+// format are rescaled to 8 or 16 bits.
+[[nodiscard]] uint32_t get_bits_per_sample(const PnmType type, const uint32_t max_value) noexcept
+{
+    const auto bits_per_sample{static_cast<uint32_t>(std::bit_width(max_value))};
+    if (type == PnmType::Bitmap)
+        return bits_per_sample;
+
+    if (std::has_single_bit(max_value + 1))
+    {
+        switch (bits_per_sample)
+        {
+        case 8:
+        case 16:
+            return bits_per_sample;
+
+        case 2:
+        case 4:
+        case 10:
+        case 12:
+            if (type == PnmType::Graymap)
+                return bits_per_sample;
+            break;
+
+        default:
+            break;
+        }
+    }
+
+    return bits_per_sample <= 8 ? 8 : 16;
+}
+
+// Upper bound for the scratch buffer that holds a band of rows before it is packed (2 and 4 bit) or narrowed (16 bit).
+constexpr size_t max_scratch_buffer_size{64 * 1024};
+
+// Smaller images are converted on the calling thread, starting the worker threads would cost more than it gains.
+constexpr size_t parallel_decode_threshold{4 * 1024 * 1024};
+
+// Larger regions are read ahead (on a background thread for a stream, by the OS for a memory mapped file): the latency
+// of the next read overlaps with the conversion of the data that is already read.
+constexpr size_t read_ahead_threshold{4 * 1024 * 1024};
+
+// Larger regions of a stream are read in bands by concurrent reads on clones of the stream: 1 chain of sequential
+// reads cannot keep high latency storage (for example a network share on a RAID array) busy.
+constexpr size_t parallel_read_threshold{16 * 1024 * 1024};
+constexpr size_t parallel_read_count{4};
+
+// Rows are read and converted in bands that fit in the L2 cache of a core: the samples are converted before they are
+// evicted from the cache, which saves a second pass over memory.
+constexpr size_t cache_band_size{256 * 1024};
+
+// The stream position of every 64th row of an ASCII image is recorded when it is parsed: a region starts at most 63
+// rows after a known position, which keeps decoding an ASCII image in strips linear.
+constexpr int32_t ascii_row_index_interval{64};
+
+[[nodiscard]] size_t get_worker_thread_count(const size_t sample_data_size) noexcept
+{
+    return sample_data_size < parallel_decode_threshold ? 0 : band_worker_pool::recommended_thread_count();
+}
+
+[[nodiscard]] size_t get_band_height(const size_t band_size, const size_t row_size, const size_t height) noexcept
 {
-    transform(samples, samples.begin(), [](const uint16_t sample) noexcept -> uint16_t { return byteswap(sample); });
+    return std::clamp(band_size / row_size, size_t{1}, height);
 }
 
-constexpr void convert_to_little_endian_and_shift(span<uint16_t> samples, const uint32_t sample_shift) noexcept
+// Returns the pool that converts the bands: the pool that is shared by the concurrent reads of a region, an own pool
+// for a large region or no pool.
+[[nodiscard]] band_worker_pool* get_worker_pool(band_worker_pool* shared_worker_pool, const size_t sample_data_size,
+                                                std::optional<band_worker_pool>& own_worker_pool)
 {
-    transform(samples, samples.begin(),
-              [sample_shift](const uint16_t sample) noexcept -> uint16_t { return byteswap(sample) << sample_shift; });
+    if (shared_worker_pool)
+        return shared_worker_pool;
+
+    if (const size_t thread_count{get_worker_thread_count(sample_data_size)}; thread_count != 0)
+        return &own_worker_pool.emplace(thread_count);
+
+    return nullptr;
 }
 
-constexpr void convert_to_little_endian_and_optional_shift(const span<uint16_t> samples,
-                                                           const uint32_t sample_shift) noexcept
+void read_rows(buffered_stream_reader& stream_reader, const size_t row_size, const size_t height, const size_t stride,
+               span<std::byte> destination_samples)
 {
-    if (sample_shift == 0)
+    if (row_size == stride)
+    {
+        stream_reader.read_bytes(destination_samples.data(), destination_samples.size());
+    }
+    else if (stream_reader.is_memory_backed())
     {
-        convert_to_little_endian(samples);
+        std::byte* line{destination_samples.data()};
+        for (size_t row{height}; row; --row)
+        {
+            stream_reader.read_bytes(line, row_size);
+            line += stride;
+        }
     }
     else
     {
-        convert_to_little_endian_and_shift(samples, sample_shift);
+        // A stream is read with 1 call per band instead of 1 call per row: the rows of a band are read packed and then
+        // moved to their padded position while they are in the cache, last row first. A row is never overwritten
+        // before it is moved.
+        const size_t band_height{get_band_height(cache_band_size, stride, height)};
+        for (size_t row{}; row < height; row += band_height)
+        {
+            const size_t rows{std::min(band_height, height - row)};
+            std::byte* band{destination_samples.data() + row * stride};
+            stream_reader.read_bytes(band, row_size * rows);
+            for (size_t band_row{rows - 1}; band_row != 0; --band_row)
+            {
+                std::memmove(band + band_row * stride, band + band_row * row_size, row_size);
+            }
+        }
     }
 }
 
-void pack_to_crumbs(const span<const std::byte> byte_pixels, std::byte* crumb_pixels, const size_t width,
-                    const size_t height, const size_t stride) noexcept
+void convert_rows(const size_t row_size, const size_t height, const size_t stride, const sample_converter& converter,
+                  span<std::byte> destination_samples) noexcept
 {
-    for (size_t j{}, row{}; row != height; ++row)
+    if (row_size == stride)
+    {
+        converter(destination_samples);
+    }
+    else
     {
-        std::byte* crumb_row{crumb_pixels + (row * stride)};
-        size_t i{};
-        for (; i != width / 4; ++i)
+        std::byte* line{destination_samples.data()};
+        for (size_t row{height}; row; --row)
         {
-            std::byte value{byte_pixels[j++] << 6};
-            value |= byte_pixels[j++] << 4;
-            value |= byte_pixels[j++] << 2;
-            value |= byte_pixels[j++];
-            crumb_row[i] = value;
+            converter({line, row_size});
+            line += stride;
         }
+    }
+}
+
+// The calling thread reads the bands and converts them while they are in the cache. Worker threads (if any) convert
+// a band while the next band is read.
+void read_and_convert_rows(buffered_stream_reader& stream_reader, const size_t row_size, const size_t height,
+                           const size_t stride, const sample_converter& converter, span<std::byte> destination_samples,
+                           band_worker_pool* shared_worker_pool)
+{
+    if (converter.is_identity())
+    {
+        read_rows(stream_reader, row_size, height, stride, destination_samples);
+        return;
+    }
+
+    const size_t band_height{get_band_height(cache_band_size, stride, height)};
+    std::optional<band_worker_pool> own_worker_pool;
+    band_worker_pool* worker_pool{get_worker_pool(shared_worker_pool, row_size * height, own_worker_pool)};
 
-        switch (width % 4)
+    for (size_t row{}; row != height;)
+    {
+        const size_t rows{std::min(band_height, height - row)};
+        const auto band{destination_samples.subspan(row * stride, (rows - 1) * stride + row_size)};
+        read_rows(stream_reader, row_size, rows, stride, band);
+        if (worker_pool)
+        {
+            worker_pool->submit([=, &converter] { convert_rows(row_size, rows, stride, converter, band); });
+        }
+        else
         {
-        case 3:
-            crumb_row[i] = byte_pixels[j++] << 6;
-            [[fallthrough]];
+            convert_rows(row_size, rows, stride, converter, band);
+        }
+        row += rows;
+    }
 
-        case 2:
-            crumb_row[i] |= byte_pixels[j++] << 4;
-            [[fallthrough]];
+    if (worker_pool)
+    {
+        worker_pool->wait();
+    }
+}
 
-        case 1:
-            crumb_row[i] |= byte_pixels[j++] << 2;
-            break;
+// Pixels converted to BGRA grow from 3 to 4 bytes: the RGB pixels are read at the end of the destination rows.
+[[nodiscard]] size_t get_bgr_source_offset(const bgr_conversion conversion, const size_t width) noexcept
+{
+    return conversion == bgr_conversion::rgb_to_bgra ? width : 0;
+}
 
-        default:
-            break;
-        }
+void convert_rows_to_bgr(const size_t width, const size_t row_size, const size_t height, const size_t stride,
+                         const sample_converter& converter, const bgr_conversion conversion,
+                         std::byte* destination_row) noexcept
+{
+    const size_t source_offset{get_bgr_source_offset(conversion, width)};
+    for (size_t row{height}; row; --row)
+    {
+        converter({destination_row + source_offset, row_size});
+        convert_to_bgr(conversion, destination_row, width);
+        destination_row += stride;
     }
 }
 
-void pack_to_nibbles(const span<const std::byte> byte_pixels, std::byte* nibble_pixels, const size_t width,
-                     const size_t height, const size_t stride) noexcept
+// Reads 8 bit RGB(A) rows and swizzles them to BGR(A) in bands, while the samples of a band are still in the cache.
+void read_and_convert_rows_to_bgr(buffered_stream_reader& stream_reader, const size_t width,
+                                  const size_t samples_per_pixel, const size_t height, const size_t stride,
+                                  const sample_converter& converter, const bgr_conversion conversion,
+                                  span<std::byte> destination_pixels, band_worker_pool* shared_worker_pool)
 {
-    for (size_t j{}, row{}; row != height; ++row)
+    const size_t row_size{width * samples_per_pixel};
+    const size_t source_offset{get_bgr_source_offset(conversion, width)};
+    const size_t band_height{get_band_height(cache_band_size, stride, height)};
+    std::optional<band_worker_pool> own_worker_pool;
+    band_worker_pool* worker_pool{get_worker_pool(shared_worker_pool, row_size * height, own_worker_pool)};
+
+    for (size_t row{}; row != height;)
     {
-        std::byte* nibble_row{nibble_pixels + (row * stride)};
-        size_t i{};
-        for (; i != width / 2; ++i)
+        const size_t rows{std::min(band_height, height - row)};
+        std::byte* band{destination_pixels.data() + row * stride};
+        read_rows(stream_reader, row_size, rows, stride,
+                  destination_pixels.subspan(row * stride + source_offset, (rows - 1) * stride + row_size));
+        if (worker_pool)
         {
-            nibble_row[i] = byte_pixels[j++] << 4;
-            nibble_row[i] |= byte_pixels[j++];
+            worker_pool->submit([=, &converter] {
+                convert_rows_to_bgr(width, row_size, rows, stride, converter, conversion, band);
+            });
         }
-        if (width % 2)
+        else
         {
-            nibble_row[i] = byte_pixels[j++] << 4;
+            convert_rows_to_bgr(width, row_size, rows, stride, converter, conversion, band);
         }
+        row += rows;
+    }
+
+    if (worker_pool)
+    {
+        worker_pool->wait();
     }
 }
 
-void pack_to_bytes(const span<const std::byte> source_pixels, std::byte* destination_pixels, const size_t width,
-                   const size_t height, const size_t stride) noexcept
+template<typename Pack>
+void pack_rows(const span<const std::byte> samples, const size_t source_row_size, const size_t stride, const Pack& pack,
+               std::byte* destination_pixels) noexcept
 {
-    for (size_t row{}; row != height; ++row)
+    for (size_t row{}; row != samples.size() / source_row_size; ++row)
     {
-        const std::byte* source_row{source_pixels.data() + row * width};
-        std::byte* destination_row{destination_pixels + row * stride};
-        std::copy_n(source_row, width, destination_row);
+        pack(samples.subspan(row * source_row_size, source_row_size), destination_pixels);
+        destination_pixels += stride;
     }
 }
 
-void pack_to_words(const span<const uint16_t> source_pixels, uint16_t* destination_pixels, const size_t width,
-                   const size_t height, const size_t stride) noexcept
+// Reads bands of rows in a scratch buffer and packs them into the destination rows while they are in the cache.
+template<typename Pack>
+void read_and_pack_rows(buffered_stream_reader& stream_reader, const size_t source_row_size, const size_t height,
+                        const size_t stride, const Pack pack, span<std::byte> destination_pixels,
+                        band_worker_pool* shared_worker_pool)
 {
-    for (size_t row{}; row != height; ++row)
+    std::byte* line{destination_pixels.data()};
+
+    std::optional<band_worker_pool> own_worker_pool;
+    if (band_worker_pool* worker_pool{get_worker_pool(shared_worker_pool, source_row_size * height, own_worker_pool)})
+    {
+        // Every band gets its own scratch buffer, the bounded queue of the pool limits the number of buffers.
+        const size_t band_height{get_band_height(cache_band_size, source_row_size, height)};
+        for (size_t row{}; row != height;)
+        {
+            const size_t rows{std::min(band_height, height - row)};
+            std::vector<std::byte> samples(rows * source_row_size);
+            stream_reader.read_bytes(samples.data(), samples.size());
+            worker_pool->submit([samples = std::move(samples), source_row_size, stride, pack, line] {
+                pack_rows(samples, source_row_size, stride, pack, line);
+            });
+            line += rows * stride;
+            row += rows;
+        }
+        worker_pool->wait();
+        return;
+    }
+
+    const size_t band_height{get_band_height(max_scratch_buffer_size, source_row_size, height)};
+    std::vector<std::byte> scratch_buffer(band_height * source_row_size);
+    for (size_t row{}; row != height;)
     {
-        const uint16_t* source_row{source_pixels.data() + row * width};
-        uint16_t* destination_row{destination_pixels + row * (stride / 2)};
-        std::copy_n(source_row, width, destination_row);
+        const size_t rows{std::min(band_height, height - row)};
+        const span samples{scratch_buffer.data(), rows * source_row_size};
+        stream_reader.read_bytes(samples.data(), samples.size());
+        pack_rows(samples, source_row_size, stride, pack, line);
+        line += rows * stride;
+        row += rows;
     }
 }
 
-void decode_monochrome_bitmap(buffered_stream_reader& stream_reader, const pnm_header& header,
-                              const uint32_t bits_per_sample, const uint32_t sample_shift, const uint32_t stride,
-                              span<std::byte> destination_pixels)
+void decode_monochrome_bitmap(buffered_stream_reader& stream_reader, const size_t width, const size_t height,
+                              const uint32_t bits_per_sample, const sample_converter& converter, const size_t stride,
+                              span<std::byte> destination_pixels, band_worker_pool* worker_pool)
 {
     switch (bits_per_sample)
     {
     case 2:
-        pack_to_crumbs(stream_reader.read_bytes(static_cast<size_t>(header.width) * header.height),
-                       destination_pixels.data(), header.width, header.height, stride);
+        read_and_pack_rows(stream_reader, width, height, stride, pack_to_crumbs, destination_pixels, worker_pool);
         break;
 
     case 4:
-        pack_to_nibbles(stream_reader.read_bytes(static_cast<size_t>(header.width) * header.height),
-                        destination_pixels.data(), header.width, header.height, stride);
+        read_and_pack_rows(stream_reader, width, height, stride, pack_to_nibbles, destination_pixels, worker_pool);
         break;
 
     case 8:
-        if (header.width % stride == 0)
-        {
-            stream_reader.read_bytes(destination_pixels.data(), destination_pixels.size());
-        }
-        else
-        {
-            pack_to_bytes(stream_reader.read_bytes(static_cast<size_t>(header.width) * header.height),
-                          destination_pixels.data(), header.width, header.height, stride);
-        }
+        read_and_convert_rows(stream_reader, width, height, stride, converter, destination_pixels, worker_pool);
         break;
 
     default:
-        if (const auto header_width_in_bytes{static_cast<size_t>(header.width) * 2}; header_width_in_bytes % stride == 0)
-        {
-            // Binary 16 bit Netpbm images are stored in big endian format (the de facto standard).
-            stream_reader.read_bytes(destination_pixels.data(), destination_pixels.size());
-            convert_to_little_endian_and_optional_shift(
-                {reinterpret_cast<uint16_t*>(destination_pixels.data()), destination_pixels.size() / sizeof uint16_t},
-                sample_shift);
-        }
-        else
-        {
-            auto samples{stream_reader.read_bytes(header_width_in_bytes * header.height)};
-            const span samples_16_bit{reinterpret_cast<uint16_t*>(samples.data()), samples.size() / sizeof uint16_t};
-            convert_to_little_endian_and_optional_shift(samples_16_bit, sample_shift);
-            pack_to_words(samples_16_bit, reinterpret_cast<uint16_t*>(destination_pixels.data()), header.width,
-                          header.height, stride);
-        }
+        read_and_convert_rows(stream_reader, width * sizeof uint16_t, height, stride, converter, destination_pixels,
+                              worker_pool);
         break;
     }
 }
 
-void decode_color_bitmap(buffered_stream_reader& stream_reader, const pnm_header& header, const uint32_t bits_per_sample,
-                         const uint32_t stride, span<std::byte> destination_samples)
+void decode_color_bitmap(buffered_stream_reader& stream_reader, const size_t width, const size_t height,
+                         const uint32_t bits_per_sample, const sample_converter& converter,
+                         const bgr_conversion conversion, const size_t stride, span<std::byte> destination_samples,
+                         band_worker_pool* worker_pool)
 {
     constexpr size_t sample_per_pixel{3};
 
     switch (bits_per_sample)
     {
     case 8:
-        if (const auto header_width_in_bytes{header.width * sample_per_pixel}; header_width_in_bytes % stride == 0)
+        if (conversion == bgr_conversion::none)
         {
-            stream_reader.read_bytes(destination_samples.data(), destination_samples.size());
+            read_and_convert_rows(stream_reader, width * sample_per_pixel, height, stride, converter,
+                                  destination_samples, worker_pool);
         }
         else
         {
-            std::byte* line{destination_samples.data()};
-            for (uint32_t row{header.height}; row; --row)
-            {
-                stream_reader.read_bytes(line, header.width * size_t{3});
-                line += stride;
-            }
+            read_and_convert_rows_to_bgr(stream_reader, width, sample_per_pixel, height, stride, converter, conversion,
+                                         destination_samples, worker_pool);
         }
         break;
 
     case 16: {
         constexpr size_t bytes_per_sample{2};
-        if (const auto header_width_in_bytes{header.width * sample_per_pixel * bytes_per_sample};
-            header_width_in_bytes % stride == 0)
+        read_and_convert_rows(stream_reader, width * sample_per_pixel * bytes_per_sample, height, stride, converter,
+                              destination_samples, worker_pool);
+    }
+    break;
+
+    default:
+        ASSERT(false);
+        break;
+    }
+}
+
+// WIC has no gray with alpha pixel format, these samples are expanded in place to RGBA.
+// The source samples are stored in the upper half of the row: a pixel is always read before it is overwritten.
+template<typename Sample>
+void expand_gray_alpha_to_rgba(Sample* pixels, const size_t width) noexcept
+{
+    const Sample* source{pixels + width * 2};
+    for (size_t i{}; i != width; ++i)
+    {
+        const Sample gray{source[i * 2]};
+        const Sample alpha{source[i * 2 + 1]};
+        pixels[i * 4] = gray;
+        pixels[i * 4 + 1] = gray;
+        pixels[i * 4 + 2] = gray;
+        pixels[i * 4 + 3] = alpha;
+    }
+}
+
+template<uint32_t Depth, typename Sample>
+void decode_pam_rows(buffered_stream_reader& stream_reader, const size_t width, const size_t height,
+                     const sample_converter& converter, const bgr_conversion conversion, const size_t stride,
+                     span<std::byte> destination_pixels, band_worker_pool* worker_pool)
+{
+    if constexpr (Depth == 2)
+    {
+        const size_t source_row_size{width * 2 * sizeof(Sample)};
+        std::byte* line{destination_pixels.data()};
+        for (size_t row{height}; row; --row)
+        {
+            const span source_samples{line + source_row_size, source_row_size};
+            stream_reader.read_bytes(source_samples.data(), source_samples.size());
+            converter(source_samples);
+            expand_gray_alpha_to_rgba(reinterpret_cast<Sample*>(line), width);
+
+            // Gray pixels are the same in RGBA and BGRA order, only premultiplying changes them.
+            if (conversion == bgr_conversion::rgba_to_premultiplied_bgra)
+            {
+                convert_to_bgr(conversion, line, width);
+            }
+            line += stride;
+        }
+    }
+    else if (conversion != bgr_conversion::none)
+    {
+        read_and_convert_rows_to_bgr(stream_reader, width, Depth, height, stride, converter, conversion,
+                                     destination_pixels, worker_pool);
+    }
+    else
+    {
+        read_and_convert_rows(stream_reader, width * Depth * sizeof(Sample), height, stride, converter,
+                              destination_pixels, worker_pool);
+    }
+}
+
+// PAM images without an alpha channel are decoded as a graymap or a pixmap.
+void decode_pam_bitmap(buffered_stream_reader& stream_reader, const size_t width, const size_t height,
+                       const uint32_t depth, const uint32_t bits_per_sample, const sample_converter& converter,
+                       const bgr_conversion conversion, const size_t stride, span<std::byte> destination_pixels,
+                       band_worker_pool* worker_pool)
+{
+    ASSERT(depth == 2 || depth == 4);
+    ASSERT(bits_per_sample == 8 || conversion == bgr_conversion::none);
+
+    if (bits_per_sample == 8)
+    {
+        if (depth == 2)
         {
-            stream_reader.read_bytes(destination_samples.data(), destination_samples.size());
+            decode_pam_rows<2, std::uint8_t>(stream_reader, width, height, converter, conversion, stride,
+                                             destination_pixels, worker_pool);
         }
         else
         {
-            std::byte* line{destination_samples.data()};
-            for (uint32_t row{header.height}; row; --row)
-            {
-                stream_reader.read_bytes(line, header.width * sizeof uint16_t * 3);
-                line += stride;
-            }
+            decode_pam_rows<4, std::uint8_t>(stream_reader, width, height, converter, conversion, stride,
+                                             destination_pixels, worker_pool);
         }
-        convert_to_little_endian_and_optional_shift(
-            {reinterpret_cast<uint16_t*>(destination_samples.data()), destination_samples.size() / sizeof uint16_t}, 0);
     }
-    break;
+    else
+    {
+        ASSERT(bits_per_sample == 16);
+        if (depth == 2)
+        {
+            decode_pam_rows<2, uint16_t>(stream_reader, width, height, converter, conversion, stride,
+                                         destination_pixels, worker_pool);
+        }
+        else
+        {
+            decode_pam_rows<4, uint16_t>(stream_reader, width, height, converter, conversion, stride,
+                                         destination_pixels, worker_pool);
+        }
+    }
+}
 
-    default:
-        ASSERT(false);
-        break;
+// Rounds the big endian 16 bit samples to 8 bits while the band that is read is still in the cache: only 8 bit pixels
+// are written to the destination. Gray with alpha samples are narrowed into the upper half of the RGBA rows.
+void read_and_narrow_rows(buffered_stream_reader& stream_reader, const size_t width, const uint32_t depth,
+                          const size_t height, const uint16_t max_value, const size_t stride,
+                          span<std::byte> destination_pixels, band_worker_pool* worker_pool)
+{
+    const size_t source_row_size{width * depth * sizeof(uint16_t)};
+    if (depth == 2)
+    {
+        read_and_pack_rows(
+            stream_reader, source_row_size, height, stride,
+            [width, max_value](const span<const std::byte> samples, std::byte* destination_row) noexcept {
+                narrow_to_8_bit(samples, max_value, destination_row + width * 2);
+                expand_gray_alpha_to_rgba(reinterpret_cast<std::uint8_t*>(destination_row), width);
+            },
+            destination_pixels, worker_pool);
+    }
+    else
+    {
+        read_and_pack_rows(
+            stream_reader, source_row_size, height, stride,
+            [max_value](const span<const std::byte> samples, std::byte* destination_row) noexcept {
+                narrow_to_8_bit(samples, max_value, destination_row);
+            },
+            destination_pixels, worker_pool);
     }
 }
 
-void decode_pam_bitmap(buffered_stream_reader& stream_reader, const pnm_header& header, const uint32_t bits_per_sample,
-                       const uint32_t stride, span<std::byte> destination_samples)
+// Netpbm bitmaps use 1 for black, WIC BlackWhite uses 1 for white. The padding bits of the last byte are cleared.
+void convert_rows_to_black_white(const size_t width, const size_t height, const size_t stride,
+                                 span<std::byte> destination_pixels) noexcept
 {
-    constexpr size_t sample_per_pixel{4};
+    const size_t row_size{(width + 7) / 8};
+    if (row_size == stride)
+    {
+        invert_bits(destination_pixels);
+    }
+    else
+    {
+        std::byte* line{destination_pixels.data()};
+        for (size_t row{height}; row; --row)
+        {
+            invert_bits({line, row_size});
+            line += stride;
+        }
+    }
 
-    switch (bits_per_sample)
+    if (const size_t padding_bits{row_size * 8 - width}; padding_bits != 0)
     {
-    case 8:
-        if (const auto header_width_in_bytes{header.width * sample_per_pixel}; header_width_in_bytes % stride == 0)
+        const auto padding_mask{static_cast<std::byte>(0xFF << padding_bits)};
+        std::byte* last_byte{destination_pixels.data() + row_size - 1};
+        for (size_t row{height}; row; --row)
+        {
+            *last_byte &= padding_mask;
+            last_byte += stride;
+        }
+    }
+}
+
+// A region that doesn't start at a byte boundary is shifted to the start of the destination rows.
+void read_bitmap_rows(buffered_stream_reader& stream_reader, const size_t source_row_size, const size_t bit_offset,
+                      const size_t width, const size_t height, const size_t stride, span<std::byte> destination_pixels)
+{
+    const size_t row_size{(width + 7) / 8};
+    if (bit_offset == 0 && row_size == source_row_size)
+    {
+        read_rows(stream_reader, row_size, height, stride, destination_pixels);
+        return;
+    }
+
+    const size_t read_size{(bit_offset + width + 7) / 8};
+    std::vector<std::byte> row_bits(read_size + 1);
+    std::byte* line{destination_pixels.data()};
+    for (size_t row{}; row != height; ++row)
+    {
+        if (row != 0)
+        {
+            stream_reader.skip(source_row_size - read_size);
+        }
+
+        stream_reader.read_bytes(row_bits.data(), read_size);
+        if (bit_offset == 0)
         {
-            stream_reader.read_bytes(destination_samples.data(), destination_samples.size());
+            std::memcpy(line, row_bits.data(), row_size);
         }
         else
         {
-            std::byte* line{destination_samples.data()};
-            for (uint32_t row{header.height}; row; --row)
+            for (size_t i{}; i != row_size; ++i)
             {
-                stream_reader.read_bytes(line, header.width * size_t{4});
-                line += stride;
+                line[i] = row_bits[i] << bit_offset | row_bits[i + 1] >> (8 - bit_offset);
             }
         }
-        break;
 
-    default:
-        ASSERT(false);
-        break;
+        line += stride;
     }
 }
 
-[[nodiscard]] com_ptr<IWICBitmap> create_bitmap(_In_ IStream* source_stream, _In_ IWICImagingFactory* factory)
+void read_ascii_bits(buffered_stream_reader& stream_reader, span<std::byte> samples)
 {
-    buffered_stream_reader stream_reader{source_stream};
-    const pnm_header header{stream_reader};
-    const uint32_t bits_per_sample{static_cast<uint32_t>(std::bit_width(header.MaxColorValue))};
-    const auto& [pixel_format, sample_shift] = get_pixel_format_and_shift(header.PnmType, bits_per_sample);
+    for (;;)
+    {
+        const auto [consumed, sample_count, valid]{parse_ascii_bits(stream_reader.buffered_data(), samples)};
+        check_condition(valid, wincodec::error_bad_image);
+        stream_reader.consume(consumed);
+        samples = samples.subspan(sample_count);
+        if (samples.empty())
+            return;
 
-    com_ptr<IWICBitmap> bitmap;
-    check_hresult(factory->CreateBitmap(header.width, header.height, pixel_format, WICBitmapCacheOnLoad, bitmap.put()));
-    check_hresult(bitmap->SetResolution(96., 96.));
+        check_condition(stream_reader.fill_buffer(), wincodec::error_stream_read);
+    }
+}
 
-    const WICRect complete_image{
-        .X{0}, .Y{0}, .Width{static_cast<int32_t>(header.width)}, .Height{static_cast<int32_t>(header.height)}};
-    com_ptr<IWICBitmapLock> bitmap_lock;
-    check_hresult(bitmap->Lock(&complete_image, WICBitmapLockWrite, bitmap_lock.put()));
+// Packs the samples of a P1 row in the bit layout of the binary bitmap format (1 is black).
+void pack_to_bits(const span<const std::byte> samples, std::byte* destination_row) noexcept
+{
+    std::memset(destination_row, 0, (samples.size() + 7) / 8);
+    for (size_t i{}; i != samples.size(); ++i)
+    {
+        destination_row[i / 8] |= samples[i] << (7 - i % 8);
+    }
+}
 
-    uint32_t stride;
-    winrt::check_hresult(bitmap_lock->GetStride(&stride));
+void read_ascii_samples(buffered_stream_reader& stream_reader, span<uint16_t> samples)
+{
+    for (bool end_of_text{};;)
+    {
+        const auto [consumed, sample_count, valid]{
+            parse_ascii_samples(stream_reader.buffered_data(), samples, end_of_text)};
+        check_condition(valid, wincodec::error_bad_image);
+        stream_reader.consume(consumed);
+        samples = samples.subspan(sample_count);
+        if (samples.empty())
+            return;
 
-    std::byte* data_buffer;
-    uint32_t data_buffer_size;
-    winrt::check_hresult(bitmap_lock->GetDataPointer(&data_buffer_size, reinterpret_cast<BYTE**>(&data_buffer)));
-    __assume(data_buffer != nullptr);
+        check_condition(!end_of_text, wincodec::error_stream_read);
+        end_of_text = !stream_reader.fill_buffer();
+    }
+}
 
-    switch (header.PnmType)
+void store_ascii_samples(const span<uint16_t> samples, const uint32_t bits_per_sample,
+                         const sample_converter& converter, std::byte* destination_row) noexcept
+{
+    for (uint16_t& sample : samples)
     {
-    case PnmType::Graymap:
-        decode_monochrome_bitmap(stream_reader, header, bits_per_sample, sample_shift, stride,
-                                 {data_buffer, data_buffer_size});
-        break;
+        sample = converter.convert(sample);
+    }
 
-    case PnmType::Pixmap:
-        decode_color_bitmap(stream_reader, header, bits_per_sample, stride, {data_buffer, data_buffer_size});
+    if (bits_per_sample > 8)
+    {
+        std::memcpy(destination_row, samples.data(), samples.size_bytes());
+        return;
+    }
+
+    // Narrow in place: every byte is written over a sample that is already read.
+    const span byte_samples{reinterpret_cast<std::byte*>(samples.data()), samples.size()};
+    for (size_t i{}; i != samples.size(); ++i)
+    {
+        byte_samples[i] = static_cast<std::byte>(samples[i]);
+    }
+
+    switch (bits_per_sample)
+    {
+    case 2:
+        pack_to_crumbs(byte_samples, destination_row);
         break;
 
-    case PnmType::ArbitraryMap:
-        decode_pam_bitmap(stream_reader, header, bits_per_sample, stride, {data_buffer, data_buffer_size});
+    case 4:
+        pack_to_nibbles(byte_samples, destination_row);
         break;
 
     default:
+        std::memcpy(destination_row, byte_samples.data(), byte_samples.size());
         break;
     }
-
-    return bitmap;
 }
 
-} // namespace
-
-
-netpbm_bitmap_frame_decode::netpbm_bitmap_frame_decode(_In_ IStream* source_stream, _In_ IWICImagingFactory* factory) :
-    bitmap_source_{create_bitmap(source_stream, factory)}
+// Returns the number of samples per pixel of the WIC pixel format, gray with alpha is decoded as RGBA.
+[[nodiscard]] uint32_t get_samples_per_pixel(const PnmType type) noexcept
 {
-}
+    switch (type)
+    {
+    case PnmType::Bitmap:
+    case PnmType::Graymap:
+        return 1;
 
+    case PnmType::Pixmap:
+        return 3;
 
-// IWICBitmapSource
-HRESULT __stdcall netpbm_bitmap_frame_decode::GetSize(uint32_t* width, uint32_t* height)
-{
-    TRACE("{} netpbm_bitmap_frame_decode::GetSize, width address={}, height address={}\n", fmt_ptr(this), fmt_ptr(width),
-          fmt_ptr(height));
-    return bitmap_source_->GetSize(width, height);
-}
+    case PnmType::ArbitraryMap:
+        return 4;
+    }
 
-HRESULT __stdcall netpbm_bitmap_frame_decode::GetPixelFormat(GUID* pixel_format)
-{
-    TRACE("{} netpbm_bitmap_frame_decode::GetPixelFormat.1, pixel_format address={}\n", fmt_ptr(this),
-          fmt_ptr(pixel_format));
-    return bitmap_source_->GetPixelFormat(pixel_format);
+    std::unreachable();
 }
 
-HRESULT __stdcall netpbm_bitmap_frame_decode::GetResolution(double* dpi_x, double* dpi_y)
+[[nodiscard]] uint32_t get_bits_per_pixel(const PnmType type, const uint32_t bits_per_sample) noexcept
 {
-    TRACE("{} netpbm_bitmap_frame_decode::GetResolution, dpi_x address={}, dpi_y address={}\n", fmt_ptr(this),
-          fmt_ptr(dpi_x), fmt_ptr(dpi_y));
-    return bitmap_source_->GetResolution(dpi_x, dpi_y);
+    if (type == PnmType::Bitmap)
+        return 1;
+
+    const uint32_t bits_per_stored_sample{bits_per_sample > 8 ? 16U : bits_per_sample};
+    return bits_per_stored_sample * get_samples_per_pixel(type);
 }
 
-HRESULT __stdcall netpbm_bitmap_frame_decode::CopyPixels(const WICRect* rectangle, const uint32_t stride,
-                                                         const uint32_t buffer_size, BYTE* buffer)
+// Returns the conversion that decodes the 8 bit RGB(A) pixel formats directly to a BGR(A) pixel format, none if the
+// pixel format can't be decoded to the destination format.
+[[nodiscard]] bgr_conversion get_bgr_conversion(const GUID& pixel_format, const GUID& destination_format) noexcept
 {
-    TRACE("{} netpbm_bitmap_frame_decode::CopyPixels, rectangle address={}, stride={}, buffer_size={}, buffer "
-          "address={}\n",
-          fmt_ptr(this), static_cast<const void*>(rectangle), stride, buffer_size, fmt_ptr(buffer));
-    return bitmap_source_->CopyPixels(rectangle, stride, buffer_size, buffer);
+    if (pixel_format == GUID_WICPixelFormat24bppRGB)
+    {
+        if (destination_format == GUID_WICPixelFormat24bppBGR)
+            return bgr_conversion::rgb_to_bgr;
+
+        if (destination_format == GUID_WICPixelFormat32bppBGR || destination_format == GUID_WICPixelFormat32bppBGRA ||
+            destination_format == GUID_WICPixelFormat32bppPBGRA)
+            return bgr_conversion::rgb_to_bgra;
+    }
+    else if (pixel_format == GUID_WICPixelFormat32bppRGBA)
+    {
+        if (destination_format == GUID_WICPixelFormat32bppBGRA)
+            return bgr_conversion::rgba_to_bgra;
+
+        if (destination_format == GUID_WICPixelFormat32bppPBGRA)
+            return bgr_conversion::rgba_to_premultiplied_bgra;
+    }
+
+    return bgr_conversion::none;
 }
 
-HRESULT __stdcall netpbm_bitmap_frame_decode::CopyPalette(IWICPalette*) noexcept
+// Returns true when the destination format holds the same samples as the 16 bit pixel format, rounded to 8 bits.
+[[nodiscard]] bool is_narrowed_pixel_format(const GUID& pixel_format, const GUID& destination_format) noexcept
 {
-    TRACE("{} netpbm_bitmap_frame_decode::CopyPalette (not supported)\n", fmt_ptr(this));
-    return wincodec::error_palette_unavailable;
+    return (pixel_format == GUID_WICPixelFormat16bppGray && destination_format == GUID_WICPixelFormat8bppGray) ||
+           (pixel_format == GUID_WICPixelFormat48bppRGB && destination_format == GUID_WICPixelFormat24bppRGB) ||
+           (pixel_format == GUID_WICPixelFormat64bppRGBA && destination_format == GUID_WICPixelFormat32bppRGBA);
 }
 
-// IWICBitmapFrameDecode : IWICBitmapSource
+// Number of rows that are decoded before they are rotated or flipped, small enough to stay in the cache.
+constexpr uint32_t transform_band_height{32};
 
-HRESULT __stdcall netpbm_bitmap_frame_decode::GetThumbnail(IWICBitmapSource**) noexcept
+[[nodiscard]] constexpr uint32_t divide_round_up(const uint32_t value, const uint32_t divisor) noexcept
 {
-    TRACE("{} netpbm_bitmap_frame_decode::GetThumbnail (not supported)\n", fmt_ptr(this));
-    return wincodec::error_codec_no_thumbnail;
+    return (value + divisor - 1) / divisor;
 }
 
-HRESULT __stdcall netpbm_bitmap_frame_decode::GetColorContexts([[maybe_unused]] const uint32_t count,
-                                                               [[maybe_unused]] IWICColorContext** color_contexts,
-                                                               uint32_t* actual_count) noexcept
-try
+[[nodiscard]] bool is_valid_region(const WICRect& region, const uint32_t width, const uint32_t height) noexcept
 {
-    TRACE("{} netpbm_bitmap_frame_decode::GetColorContexts (always 0), count={}, color_contexts address={}, "
-          "actual_count address={}\n",
-          fmt_ptr(this), count, fmt_ptr(color_contexts), fmt_ptr(actual_count));
-    *check_out_pointer(actual_count) = 0;
-    return success_ok;
+    return region.X >= 0 && region.Y >= 0 && region.Width >= 0 && region.Height >= 0 &&
+           static_cast<uint32_t>(region.X) + region.Width <= width &&
+           static_cast<uint32_t>(region.Y) + region.Height <= height;
 }
-catch (...)
+
+// Layout of a rotated and flipped region in the destination: source pixel (x, y) is stored at
+// origin + x * column_step + y * row_step.
+struct transform_layout final
 {
-    return to_hresult();
-}
+    ptrdiff_t origin;
+    ptrdiff_t column_step;
+    ptrdiff_t row_step;
+};
 
-HRESULT __stdcall netpbm_bitmap_frame_decode::GetMetadataQueryReader(
-    [[maybe_unused]] IWICMetadataQueryReader** metadata_query_reader) noexcept
+[[nodiscard]] transform_layout get_transform_layout(const WICBitmapTransformOptions transform, const uint32_t width,
+                                                    const uint32_t height, const ptrdiff_t pixel_size,
+                                                    const ptrdiff_t stride) noexcept
+{
+    // Every rotation and flip is a transpose (for 90 and 270 degrees) followed by flips of the destination.
+    const auto rotation{static_cast<WICBitmapTransformOptions>(transform & 3)};
+    const bool transpose{rotation == WICBitmapTransformRotate90 || rotation == WICBitmapTransformRotate270};
+    const bool flip_horizontal{(rotation == WICBitmapTransformRotate90 || rotation == WICBitmapTransformRotate180) !=
+                               ((transform & WICBitmapTransformFlipHorizontal) != 0)};
+    const bool flip_vertical{(rotation == WICBitmapTransformRotate180 || rotation == WICBitmapTransformRotate270) !=
+                             ((transform & WICBitmapTransformFlipVertical) != 0)};
+
+    const ptrdiff_t column_step{transpose ? (flip_vertical ? -stride : stride)
+                                          : (flip_horizontal ? -pixel_size : pixel_size)};
+    const ptrdiff_t row_step{transpose ? (flip_horizontal ? -pixel_size : pixel_size)
+                                       : (flip_vertical ? -stride : stride)};
+    ptrdiff_t origin{};
+    if (column_step < 0)
+    {
+        origin -= (static_cast<ptrdiff_t>(width) - 1) * column_step;
+    }
+    if (row_step < 0)
+    {
+        origin -= (static_cast<ptrdiff_t>(height) - 1) * row_step;
+    }
+
+    return {.origin{origin}, .column_step{column_step}, .row_step{row_step}};
+}
+
+// Planes hold 1 sample per pixel.
+[[nodiscard]] GUID get_plane_pixel_format(const uint32_t bits_per_sample) noexcept
+{
+    switch (bits_per_sample)
+    {
+    case 8:
+        return GUID_WICPixelFormat8bppGray;
+
+    case 16:
+        return GUID_WICPixelFormat16bppGray;
+
+    default:
+        return GUID_WICPixelFormat32bppGrayFloat;
+    }
+}
+
+constexpr uint32_t thumbnail_size{256};
+
+// The maximum number of rows that is read for a row of the thumbnail, the other rows of the block are skipped.
+constexpr uint32_t thumbnail_rows_per_block{4};
+
+[[nodiscard]] GUID get_thumbnail_pixel_format(const uint32_t samples_per_pixel) noexcept
+{
+    switch (samples_per_pixel)
+    {
+    case 1:
+        return GUID_WICPixelFormat8bppGray;
+
+    case 3:
+        return GUID_WICPixelFormat24bppRGB;
+
+    default:
+        return GUID_WICPixelFormat32bppRGBA;
+    }
+}
+
+} // namespace
+
+
+netpbm_bitmap_frame_decode::netpbm_bitmap_frame_decode(_In_ IStream* source_stream,
+                                                       std::shared_ptr<std::mutex> source_stream_mutex,
+                                                       std::shared_ptr<imaging_factory_cache> imaging_factory,
+                                                       const pnm_header& header,
+                                                       const std::uint64_t pixel_data_position) :
+    source_stream_mutex_{std::move(source_stream_mutex)},
+    imaging_factory_{std::move(imaging_factory)},
+    header_{header},
+    bits_per_sample_{get_bits_per_sample(header.PnmType, header.MaxColorValue)},
+    pixel_data_position_{pixel_data_position},
+    ascii_row_positions_{pixel_data_position}
+{
+    // The file is mapped or the stream is cloned by the first decode: frames that are only queried don't pay for it.
+    source_stream_.copy_from(source_stream);
+
+    if (header_.FloatFormat)
+    {
+        pixel_format_ = header_.depth == 1 ? GUID_WICPixelFormat32bppGrayFloat : GUID_WICPixelFormat96bppRGBFloat;
+        bits_per_sample_ = 32;
+        bits_per_pixel_ = bits_per_sample_ * header_.depth;
+        return;
+    }
+
+    uint32_t sample_shift;
+    std::tie(pixel_format_, sample_shift) = get_pixel_format_and_shift(header_.PnmType, bits_per_sample_);
+    sample_converter_ = sample_converter{bits_per_sample_, sample_shift, header.MaxColorValue};
+    bits_per_pixel_ = get_bits_per_pixel(header_.PnmType, bits_per_sample_);
+}
+
+
+// IWICBitmapSource
+HRESULT __stdcall netpbm_bitmap_frame_decode::GetSize(uint32_t* width, uint32_t* height) noexcept
+try
+{
+    TRACE("{} netpbm_bitmap_frame_decode::GetSize, width address={}, height address={}\n", fmt_ptr(this), fmt_ptr(width),
+          fmt_ptr(height));
+
+    *check_in_pointer(width) = header_.width;
+    *check_in_pointer(height) = header_.height;
+    return success_ok;
+}
+catch (...)
+{
+    return to_hresult();
+}
+
+HRESULT __stdcall netpbm_bitmap_frame_decode::GetPixelFormat(GUID* pixel_format) noexcept
+try
+{
+    TRACE("{} netpbm_bitmap_frame_decode::GetPixelFormat.1, pixel_format address={}\n", fmt_ptr(this),
+          fmt_ptr(pixel_format));
+
+    *check_in_pointer(pixel_format) = pixel_format_;
+    return success_ok;
+}
+catch (...)
+{
+    return to_hresult();
+}
+
+HRESULT __stdcall netpbm_bitmap_frame_decode::GetResolution(double* dpi_x, double* dpi_y) noexcept
+try
+{
+    TRACE("{} netpbm_bitmap_frame_decode::GetResolution, dpi_x address={}, dpi_y address={}\n", fmt_ptr(this),
+          fmt_ptr(dpi_x), fmt_ptr(dpi_y));
+
+    // The Netpbm format doesn't store the resolution, use the Windows default.
+    *check_in_pointer(dpi_x) = 96.;
+    *check_in_pointer(dpi_y) = 96.;
+    return success_ok;
+}
+catch (...)
+{
+    return to_hresult();
+}
+
+HRESULT __stdcall netpbm_bitmap_frame_decode::CopyPixels(const WICRect* rectangle, const uint32_t stride,
+                                                         const uint32_t buffer_size, BYTE* buffer) noexcept
+try
+{
+    TRACE("{} netpbm_bitmap_frame_decode::CopyPixels, rectangle address={}, stride={}, buffer_size={}, buffer "
+          "address={}\n",
+          fmt_ptr(this), static_cast<const void*>(rectangle), stride, buffer_size, fmt_ptr(buffer));
+
+    const WICRect complete_image{
+        .X{0}, .Y{0}, .Width{static_cast<int32_t>(header_.width)}, .Height{static_cast<int32_t>(header_.height)}};
+    const WICRect& region{rectangle ? *rectangle : complete_image};
+    check_condition(is_valid_region(region, header_.width, header_.height), error_invalid_argument);
+    if (region.Width == 0 || region.Height == 0)
+        return success_ok;
+
+    const size_t row_size{compute_row_size(region.Width, destination_format{})};
+    const size_t required_size{(region.Height - size_t{1}) * stride + row_size};
+    check_condition(stride >= row_size, error_invalid_argument);
+    check_condition(buffer_size >= required_size, wincodec::error_insufficient_buffer);
+    const span destination{reinterpret_cast<std::byte*>(check_in_pointer(buffer)), required_size};
+
+    decode_pixels(region, {}, stride, destination);
+
+    return success_ok;
+}
+catch (...)
+{
+    return to_hresult();
+}
+
+HRESULT __stdcall netpbm_bitmap_frame_decode::CopyPalette(IWICPalette*) noexcept
+{
+    TRACE("{} netpbm_bitmap_frame_decode::CopyPalette (not supported)\n", fmt_ptr(this));
+    return wincodec::error_palette_unavailable;
+}
+
+// IWICBitmapFrameDecode : IWICBitmapSource
+
+HRESULT __stdcall netpbm_bitmap_frame_decode::GetThumbnail(IWICBitmapSource** thumbnail) noexcept
+try
+{
+    TRACE("{} netpbm_bitmap_frame_decode::GetThumbnail, thumbnail address={}\n", fmt_ptr(this), fmt_ptr(thumbnail));
+
+    // Rows of ASCII images can only be located by parsing all preceding samples and float samples have no fixed range:
+    // the caller can decode and scale the complete image itself.
+    check_out_pointer(thumbnail);
+    if (header_.AsciiFormat || header_.FloatFormat)
+        return wincodec::error_codec_no_thumbnail;
+
+    create_thumbnail().copy_to(thumbnail);
+    return success_ok;
+}
+catch (...)
+{
+    return to_hresult();
+}
+
+HRESULT __stdcall netpbm_bitmap_frame_decode::GetColorContexts([[maybe_unused]] const uint32_t count,
+                                                               [[maybe_unused]] IWICColorContext** color_contexts,
+                                                               uint32_t* actual_count) noexcept
+try
+{
+    TRACE("{} netpbm_bitmap_frame_decode::GetColorContexts (always 0), count={}, color_contexts address={}, "
+          "actual_count address={}\n",
+          fmt_ptr(this), count, fmt_ptr(color_contexts), fmt_ptr(actual_count));
+    *check_out_pointer(actual_count) = 0;
+    return success_ok;
+}
+catch (...)
+{
+    return to_hresult();
+}
+
+HRESULT __stdcall netpbm_bitmap_frame_decode::GetMetadataQueryReader(
+    [[maybe_unused]] IWICMetadataQueryReader** metadata_query_reader) noexcept
 {
     TRACE("{} netpbm_bitmap_decoder::GetMetadataQueryReader, metadata_query_reader address={}\n", fmt_ptr(this),
           fmt_ptr(metadata_query_reader));
     return wincodec::error_unsupported_operation;
 }
+
+// IWICBitmapSourceTransform
+
+HRESULT __stdcall netpbm_bitmap_frame_decode::CopyPixels(const WICRect* rectangle, const uint32_t width,
+                                                         const uint32_t height, WICPixelFormatGUID* pixel_format,
+                                                         const WICBitmapTransformOptions transform,
+                                                         const uint32_t stride, const uint32_t buffer_size,
+                                                         BYTE* buffer) noexcept
+try
+{
+    TRACE("{} netpbm_bitmap_frame_decode::CopyPixels (transform), rectangle address={}, width={}, height={}, "
+          "transform={}, stride={}, buffer_size={}, buffer address={}\n",
+          fmt_ptr(this), static_cast<const void*>(rectangle), width, height, static_cast<int>(transform), stride,
+          buffer_size, fmt_ptr(buffer));
+
+    const auto format{get_destination_format(*check_in_pointer(pixel_format))};
+    check_condition(format.has_value(), wincodec::error_unsupported_pixel_format);
+    check_condition(transform == WICBitmapTransformRotate0 || bits_per_pixel_ % 8 == 0,
+                    wincodec::error_unsupported_operation);
+    const uint32_t factor{compute_scale_factor(width, height)};
+
+    const WICRect scaled_image{
+        .X{0}, .Y{0}, .Width{static_cast<int32_t>(width)}, .Height{static_cast<int32_t>(height)}};
+    const WICRect& region{rectangle ? *rectangle : scaled_image};
+    check_condition(is_valid_region(region, width, height), error_invalid_argument);
+    if (region.Width == 0 || region.Height == 0)
+        return success_ok;
+
+    // Rotations by 90 and 270 degrees swap the width and height of the destination.
+    const bool transpose{(transform & WICBitmapTransformRotate90) != 0};
+    const auto destination_width{static_cast<uint32_t>(transpose ? region.Height : region.Width)};
+    const size_t destination_height{static_cast<size_t>(transpose ? region.Width : region.Height)};
+    const size_t row_size{compute_row_size(destination_width, *format)};
+    const size_t required_size{(destination_height - 1) * stride + row_size};
+    check_condition(stride >= row_size, error_invalid_argument);
+    check_condition(buffer_size >= required_size, wincodec::error_insufficient_buffer);
+    const span destination{reinterpret_cast<std::byte*>(check_in_pointer(buffer)), required_size};
+
+    if (transform == WICBitmapTransformRotate0)
+    {
+        decode_destination_pixels(region, factor, *format, stride, destination);
+    }
+    else
+    {
+        decode_transformed_pixels(region, factor, transform, *format, stride, destination);
+    }
+
+    return success_ok;
+}
+catch (...)
+{
+    return to_hresult();
+}
+
+HRESULT __stdcall netpbm_bitmap_frame_decode::GetClosestSize(uint32_t* width, uint32_t* height) noexcept
+try
+{
+    TRACE("{} netpbm_bitmap_frame_decode::GetClosestSize, width address={}, height address={}\n", fmt_ptr(this),
+          fmt_ptr(width), fmt_ptr(height));
+
+    // Scaled sizes are the image size divided by an integer factor, every scaled pixel is the average of a block of
+    // factor x factor pixels. Packed pixels with less than 8 bits per pixel are not scaled.
+    uint32_t factor{1};
+    if (bits_per_pixel_ % 8 == 0 && *check_in_pointer(width) != 0 && *check_in_pointer(height) != 0)
+    {
+        factor = std::max(1U, std::min(header_.width / *width, header_.height / *height));
+    }
+
+    *check_in_pointer(width) = divide_round_up(header_.width, factor);
+    *check_in_pointer(height) = divide_round_up(header_.height, factor);
+    return success_ok;
+}
+catch (...)
+{
+    return to_hresult();
+}
+
+HRESULT __stdcall netpbm_bitmap_frame_decode::GetClosestPixelFormat(WICPixelFormatGUID* pixel_format) noexcept
+try
+{
+    TRACE("{} netpbm_bitmap_frame_decode::GetClosestPixelFormat, pixel_format address={}\n", fmt_ptr(this),
+          fmt_ptr(pixel_format));
+
+    // 8 bit RGB(A) pixels can be decoded directly to the BGR(A) formats used by Direct2D, WPF and GDI, 16 bit samples
+    // to 8 bit samples and 8 and 16 bit samples to normalized floats. Other formats are left to the WIC format
+    // converter.
+    if (!get_destination_format(*check_in_pointer(pixel_format)))
+    {
+        *pixel_format = pixel_format_;
+    }
+    return success_ok;
+}
+catch (...)
+{
+    return to_hresult();
+}
+
+HRESULT __stdcall netpbm_bitmap_frame_decode::DoesSupportTransform(const WICBitmapTransformOptions transform,
+                                                                   BOOL* is_supported) noexcept
+try
+{
+    TRACE("{} netpbm_bitmap_frame_decode::DoesSupportTransform, transform={}, is_supported address={}\n",
+          fmt_ptr(this), static_cast<int>(transform), fmt_ptr(is_supported));
+
+    // Packed pixels with less than 8 bits per pixel can't be rotated or flipped by moving bytes.
+    *check_out_pointer(is_supported) = transform == WICBitmapTransformRotate0 || bits_per_pixel_ % 8 == 0;
+    return success_ok;
+}
+catch (...)
+{
+    return to_hresult();
+}
+
+// IWICPlanarBitmapSourceTransform
+
+HRESULT __stdcall netpbm_bitmap_frame_decode::DoesSupportTransform(
+    uint32_t* width, uint32_t* height, const WICBitmapTransformOptions transform,
+    [[maybe_unused]] const WICPlanarOptions planar_options, const WICPixelFormatGUID* pixel_formats,
+    WICBitmapPlaneDescription* plane_descriptions, const uint32_t plane_count, BOOL* is_supported) noexcept
+try
+{
+    TRACE("{} netpbm_bitmap_frame_decode::DoesSupportTransform (planar), width address={}, height address={}, "
+          "transform={}, planar_options={}, pixel_formats address={}, plane_descriptions address={}, plane_count={}, "
+          "is_supported address={}\n",
+          fmt_ptr(this), fmt_ptr(width), fmt_ptr(height), static_cast<int>(transform), static_cast<int>(planar_options),
+          static_cast<const void*>(pixel_formats), fmt_ptr(plane_descriptions), plane_count, fmt_ptr(is_supported));
+
+    // The planes hold 1 sample of every pixel: the samples of the pixel format of the frame or normalized floats.
+    // Planar decoding saves the caller a pass over all pixels to split them, for example to feed a neural network.
+    *check_out_pointer(is_supported) = FALSE;
+    check_out_pointer(plane_descriptions);
+    check_hresult(GetClosestSize(width, height));
+    const span requested_formats{check_in_pointer(pixel_formats), plane_count};
+    if (plane_count == 0 || (transform != WICBitmapTransformRotate0 && bits_per_pixel_ % 8 != 0) ||
+        !std::ranges::all_of(requested_formats, [&](const GUID& format) { return format == pixel_formats[0]; }) ||
+        !get_plane_format(pixel_formats[0], plane_count))
+        return success_ok;
+
+    for (uint32_t i{}; i != plane_count; ++i)
+    {
+        plane_descriptions[i] = {.Format{pixel_formats[i]}, .Width{*width}, .Height{*height}};
+    }
+
+    *is_supported = TRUE;
+    return success_ok;
+}
+catch (...)
+{
+    return to_hresult();
+}
+
+HRESULT __stdcall netpbm_bitmap_frame_decode::CopyPixels(const WICRect* rectangle, const uint32_t width,
+                                                         const uint32_t height, const WICBitmapTransformOptions transform,
+                                                         [[maybe_unused]] const WICPlanarOptions planar_options,
+                                                         const WICBitmapPlane* planes, const uint32_t plane_count) noexcept
+try
+{
+    TRACE("{} netpbm_bitmap_frame_decode::CopyPixels (planar), rectangle address={}, width={}, height={}, "
+          "transform={}, planar_options={}, planes address={}, plane_count={}\n",
+          fmt_ptr(this), static_cast<const void*>(rectangle), width, height, static_cast<int>(transform),
+          static_cast<int>(planar_options), static_cast<const void*>(planes), plane_count);
+
+    const span destination_planes{check_in_pointer(planes), plane_count};
+    check_condition(plane_count != 0, error_invalid_argument);
+    const auto format{get_plane_format(planes[0].Format, plane_count)};
+    check_condition(format.has_value() && std::ranges::all_of(destination_planes,
+                                                              [&](const WICBitmapPlane& plane) {
+                                                                  return plane.Format == planes[0].Format;
+                                                              }),
+                    wincodec::error_unsupported_pixel_format);
+    check_condition(transform == WICBitmapTransformRotate0 || bits_per_pixel_ % 8 == 0,
+                    wincodec::error_unsupported_operation);
+    const uint32_t factor{compute_scale_factor(width, height)};
+
+    const WICRect scaled_image{
+        .X{0}, .Y{0}, .Width{static_cast<int32_t>(width)}, .Height{static_cast<int32_t>(height)}};
+    const WICRect& region{rectangle ? *rectangle : scaled_image};
+    check_condition(is_valid_region(region, width, height), error_invalid_argument);
+    if (region.Width == 0 || region.Height == 0)
+        return success_ok;
+
+    const bool transpose{(transform & WICBitmapTransformRotate90) != 0};
+    const size_t destination_width{static_cast<size_t>(transpose ? region.Height : region.Width)};
+    const size_t destination_height{static_cast<size_t>(transpose ? region.Width : region.Height)};
+    const size_t row_size{destination_width * compute_row_size(1, *format) / plane_count};
+    for (const WICBitmapPlane& plane : destination_planes)
+    {
+        check_condition(plane.cbStride >= row_size, error_invalid_argument);
+        check_condition(plane.cbBufferSize >= (destination_height - 1) * plane.cbStride + row_size,
+                        wincodec::error_insufficient_buffer);
+        check_in_pointer(plane.pbBuffer);
+    }
+
+    decode_planes(region, factor, transform, *format, destination_planes);
+    return success_ok;
+}
+catch (...)
+{
+    return to_hresult();
+}
+
+size_t netpbm_bitmap_frame_decode::compute_row_size(const uint32_t width,
+                                                    const destination_format& format) const noexcept
+{
+    if (format.float_samples_per_pixel != 0)
+        return static_cast<size_t>(width) * format.float_samples_per_pixel * sizeof(float);
+
+    // Pixels converted from RGB to BGRA grow from 3 to 4 bytes, the other conversions keep the pixel size.
+    uint32_t bits_per_pixel{format.conversion == bgr_conversion::rgb_to_bgra ? 32U : bits_per_pixel_};
+    if (format.narrow_to_8_bit)
+    {
+        bits_per_pixel /= 2;
+    }
+    return (static_cast<size_t>(width) * bits_per_pixel + 7) / 8;
+}
+
+uint32_t netpbm_bitmap_frame_decode::compute_scale_factor(const uint32_t width, const uint32_t height) const
+{
+    // The size must be one of the sizes returned by GetClosestSize: the image size divided by a common factor.
+    check_condition(width != 0 && height != 0, error_invalid_argument);
+    const uint32_t factor{std::max(divide_round_up(header_.width, width), divide_round_up(header_.height, height))};
+    check_condition(divide_round_up(header_.width, factor) == width &&
+                        divide_round_up(header_.height, factor) == height &&
+                        (factor == 1 || bits_per_pixel_ % 8 == 0),
+                    error_invalid_argument);
+    return factor;
+}
+
+std::optional<netpbm_bitmap_frame_decode::destination_format>
+netpbm_bitmap_frame_decode::get_destination_format(const GUID& pixel_format) const noexcept
+{
+    if (pixel_format == pixel_format_)
+        return destination_format{};
+
+    if (const bgr_conversion conversion{get_bgr_conversion(pixel_format_, pixel_format)};
+        conversion != bgr_conversion::none)
+        return destination_format{.conversion{conversion}};
+
+    if (is_narrowed_pixel_format(pixel_format_, pixel_format))
+        return destination_format{.narrow_to_8_bit{true}};
+
+    // 8 and 16 bit samples are normalized to the range [0, 1], RGB pixels can be expanded to RGBA.
+    if (header_.FloatFormat || bits_per_pixel_ % 8 != 0)
+        return std::nullopt;
+
+    const uint32_t samples_per_pixel{get_samples_per_pixel(header_.PnmType)};
+    if ((pixel_format == GUID_WICPixelFormat32bppGrayFloat && samples_per_pixel == 1) ||
+        (pixel_format == GUID_WICPixelFormat96bppRGBFloat && samples_per_pixel == 3))
+        return destination_format{.float_samples_per_pixel{samples_per_pixel}};
+
+    if (pixel_format == GUID_WICPixelFormat128bppRGBAFloat && samples_per_pixel != 1)
+        return destination_format{.float_samples_per_pixel{4}};
+
+    return std::nullopt;
+}
+
+std::optional<netpbm_bitmap_frame_decode::destination_format>
+netpbm_bitmap_frame_decode::get_plane_format(const GUID& pixel_format, const uint32_t plane_count) const noexcept
+{
+    // Every plane holds 1 sample of the interleaved pixels that are decoded first.
+    const uint32_t samples_per_pixel{get_samples_per_pixel(header_.PnmType)};
+    if (plane_count != samples_per_pixel || bits_per_pixel_ % 8 != 0)
+        return std::nullopt;
+
+    if (pixel_format == get_plane_pixel_format(bits_per_pixel_ / samples_per_pixel))
+        return destination_format{};
+
+    if (pixel_format == GUID_WICPixelFormat8bppGray && bits_per_pixel_ / samples_per_pixel == 16)
+        return destination_format{.narrow_to_8_bit{true}};
+
+    if (pixel_format == GUID_WICPixelFormat32bppGrayFloat)
+        return destination_format{.float_samples_per_pixel{samples_per_pixel}};
+
+    return std::nullopt;
+}
+
+void netpbm_bitmap_frame_decode::prepare_source_stream()
+{
+    std::scoped_lock lock{clone_mutex_};
+    if (source_stream_prepared_)
+        return;
+
+    // The decoder and the other frames share the source stream and its lock: it is only used to map or clone it.
+    // ASCII samples would be parsed directly in a mapped view, where an I/O error cannot be handled: only binary
+    // images are mapped.
+    std::scoped_lock stream_lock{*source_stream_mutex_};
+    if (!header_.AsciiFormat)
+    {
+        mapped_file_ = memory_mapped_file::try_map(source_stream_.get());
+    }
+
+    if (mapped_file_.empty() && failed(source_stream_->Clone(clone_source_.put())))
+    {
+        clone_source_ = nullptr;
+    }
+
+    source_stream_prepared_ = true;
+}
+
+buffered_stream_reader netpbm_bitmap_frame_decode::create_stream_reader(const std::uint64_t position)
+{
+    prepare_source_stream();
+    if (!mapped_file_.empty())
+    {
+        const auto file_data{mapped_file_.data()};
+        check_condition(position <= file_data.size(), wincodec::error_stream_read);
+        return buffered_stream_reader{file_data.subspan(static_cast<size_t>(position))};
+    }
+
+    // Every decode reads from its own clone. A stream that cannot be cloned is shared with the decoder and the other
+    // frames: it stays locked until the reader is destroyed.
+    com_ptr<IStream> stream{try_clone_source_stream()};
+    std::unique_lock<std::mutex> lock;
+    if (!stream)
+    {
+        lock = std::unique_lock{*source_stream_mutex_};
+        stream = source_stream_;
+    }
+
+    LARGE_INTEGER offset;
+    offset.QuadPart = static_cast<LONGLONG>(position);
+    check_hresult(stream->Seek(offset, STREAM_SEEK_SET, nullptr));
+    return buffered_stream_reader{stream.get(), std::move(lock)};
+}
+
+com_ptr<IStream> netpbm_bitmap_frame_decode::try_clone_source_stream()
+{
+    if (!clone_source_)
+        return nullptr;
+
+    // The clone source is never read, only the clones are: cloning is serialized, reading is not.
+    std::scoped_lock lock{clone_mutex_};
+    com_ptr<IStream> clone;
+    check_hresult(clone_source_->Clone(clone.put()));
+    return clone;
+}
+
+void netpbm_bitmap_frame_decode::decode_pixels(const WICRect& region, const destination_format& format,
+                                               const size_t stride, const span<std::byte> destination_pixels)
+{
+    if (header_.AsciiFormat)
+    {
+        decode_ascii_pixels(region, format, stride, destination_pixels);
+        return;
+    }
+
+    if (header_.FloatFormat)
+    {
+        decode_float_pixels(region, stride, destination_pixels);
+        return;
+    }
+
+    if (header_.PnmType == PnmType::Bitmap)
+    {
+        decode_bitmap_pixels(region, stride, destination_pixels);
+        return;
+    }
+
+    const size_t source_row_size{header_.width * get_source_pixel_size()};
+    const bool full_width{static_cast<uint32_t>(region.Width) == header_.width};
+    if (full_width && region.Height * source_row_size >= parallel_read_threshold &&
+        try_decode_rows_in_parallel(region, format, source_row_size, stride, destination_pixels))
+        return;
+
+    buffered_stream_reader stream_reader{create_region_reader(region)};
+    if (const size_t region_size{region.Height * source_row_size}; full_width && region_size >= read_ahead_threshold)
+    {
+        stream_reader.start_read_ahead(region_size);
+    }
+
+    decode_rows(stream_reader, region.Width, region.Height, format, stride, destination_pixels, nullptr);
+}
+
+size_t netpbm_bitmap_frame_decode::get_source_pixel_size() const noexcept
+{
+    return header_.depth * (bits_per_sample_ > 8 ? 2U : 1U);
+}
+
+buffered_stream_reader netpbm_bitmap_frame_decode::create_region_reader(const WICRect& region)
+{
+    // Binary rows have a fixed size, which makes it possible to locate the region directly in the stream. The reader
+    // skips the columns outside the region: all rows of the region are decoded by 1 call, with 1 scratch buffer.
+    const size_t source_pixel_size{get_source_pixel_size()};
+    const size_t source_row_size{header_.width * source_pixel_size};
+    buffered_stream_reader stream_reader{
+        create_stream_reader(pixel_data_position_ + region.Y * source_row_size + region.X * source_pixel_size)};
+
+    if (const size_t region_row_size{region.Width * source_pixel_size}; region_row_size != source_row_size)
+    {
+        stream_reader.set_row_gap(region_row_size, source_row_size - region_row_size);
+    }
+
+    return stream_reader;
+}
+
+bool netpbm_bitmap_frame_decode::try_decode_rows_in_parallel(const WICRect& region, const destination_format& format,
+                                                             const size_t source_row_size, const size_t stride,
+                                                             const span<std::byte> destination_pixels)
+{
+    // Every band is read from its own clone of the stream. A mapped file is already read without system calls.
+    // The bands are read by threads that don't belong to the caller: the clones must be usable from any apartment.
+    prepare_source_stream();
+    if (!clone_source_ || !is_free_threaded(clone_source_.get()))
+        return false;
+
+    const size_t height{static_cast<size_t>(region.Height)};
+    const size_t band_height{(height + parallel_read_count - 1) / parallel_read_count};
+    const size_t region_row_size{compute_row_size(region.Width, format)};
+
+    // The bands share 1 pool of worker threads: the conversion never uses more threads than the machine has cores.
+    // The pool converts a band while its thread reads the next rows, the bands are not read ahead by more threads.
+    std::optional<band_worker_pool> worker_pool;
+    if (const size_t thread_count{band_worker_pool::recommended_thread_count()}; thread_count != 0)
+    {
+        worker_pool.emplace(thread_count);
+    }
+
+    const auto decode_band{[&](const size_t first_row) {
+        const size_t rows{std::min(band_height, height - first_row)};
+        buffered_stream_reader stream_reader{
+            create_stream_reader(pixel_data_position_ + (region.Y + first_row) * source_row_size)};
+        decode_rows(stream_reader, region.Width, rows, format, stride,
+                    destination_pixels.subspan(first_row * stride, (rows - 1) * stride + region_row_size),
+                    worker_pool ? &*worker_pool : nullptr);
+    }};
+
+    std::vector<std::exception_ptr> errors(parallel_read_count - 1);
+    {
+        // The threads are joined before the errors are checked, also when the first band fails.
+        std::vector<std::jthread> threads;
+        for (size_t i{}; i != errors.size() && (i + 1) * band_height < height; ++i)
+        {
+            threads.emplace_back([&, i] {
+                try
+                {
+                    const multithreaded_apartment apartment;
+                    decode_band((i + 1) * band_height);
+                }
+                catch (...)
+                {
+                    errors[i] = std::current_exception();
+                }
+            });
+        }
+
+        decode_band(0);
+    }
+
+    for (const auto& error : errors)
+    {
+        if (error)
+            std::rethrow_exception(error);
+    }
+
+    return true;
+}
+
+void netpbm_bitmap_frame_decode::decode_scaled_pixels(const WICRect& region, const uint32_t factor,
+                                                      const destination_format& format, const size_t stride,
+                                                      const span<std::byte> destination_pixels)
+{
+    if (factor == 1)
+    {
+        decode_pixels(region, format, stride, destination_pixels);
+        return;
+    }
+
+    // Only the image columns of the region are decoded. The bands are consecutive rows: binary integer bands are read
+    // by 1 reader. ASCII images are decoded with a single call, as every call parses all preceding samples again.
+    // Narrowed samples are already rounded to 8 bits in the band.
+    const destination_format band_format{.narrow_to_8_bit{format.narrow_to_8_bit}};
+    const uint32_t samples_per_pixel{get_samples_per_pixel(header_.PnmType)};
+    const uint32_t bits_per_sample{format.narrow_to_8_bit ? 8U : bits_per_pixel_ / samples_per_pixel};
+    const uint32_t first_column{static_cast<uint32_t>(region.X) * factor};
+    const uint32_t source_width{
+        std::min(header_.width, static_cast<uint32_t>(region.X + region.Width) * factor) - first_column};
+    const size_t source_row_size{compute_row_size(source_width, band_format)};
+    const size_t source_offset{get_bgr_source_offset(format.conversion, region.Width)};
+    const uint32_t band_height{header_.AsciiFormat ? static_cast<uint32_t>(region.Height) * factor : factor};
+
+    const uint32_t first_row{static_cast<uint32_t>(region.Y) * factor};
+    std::optional<buffered_stream_reader> stream_reader;
+    if (!header_.AsciiFormat && !header_.FloatFormat)
+    {
+        const uint32_t last_row{std::min(header_.height, static_cast<uint32_t>(region.Y + region.Height) * factor)};
+        stream_reader.emplace(create_region_reader({.X{static_cast<int32_t>(first_column)},
+                                                    .Y{static_cast<int32_t>(first_row)},
+                                                    .Width{static_cast<int32_t>(source_width)},
+                                                    .Height{static_cast<int32_t>(last_row - first_row)}}));
+    }
+
+    std::vector<std::byte> band(source_row_size * std::min(band_height, header_.height - first_row));
+    for (uint32_t y{}; y != static_cast<uint32_t>(region.Height); y += band_height / factor)
+    {
+        const uint32_t band_row{first_row + y * factor};
+        const uint32_t rows{std::min(band_height, header_.height - band_row)};
+        if (stream_reader)
+        {
+            decode_rows(*stream_reader, source_width, rows, band_format, source_row_size,
+                        {band.data(), source_row_size * rows}, nullptr);
+        }
+        else
+        {
+            const WICRect band_region{.X{static_cast<int32_t>(first_column)},
+                                      .Y{static_cast<int32_t>(band_row)},
+                                      .Width{static_cast<int32_t>(source_width)},
+                                      .Height{static_cast<int32_t>(rows)}};
+            decode_pixels(band_region, band_format, source_row_size, {band.data(), source_row_size * rows});
+        }
+
+        for (uint32_t row{}; row < rows; row += factor)
+        {
+            std::byte* destination_row{destination_pixels.data() + (y + row / factor) * stride};
+            downscale_rows(band.data() + row * source_row_size, source_row_size, std::min(factor, rows - row),
+                           source_width, factor, samples_per_pixel, bits_per_sample, destination_row + source_offset);
+            convert_to_bgr(format.conversion, destination_row, region.Width);
+        }
+    }
+}
+
+void netpbm_bitmap_frame_decode::decode_destination_pixels(const WICRect& region, const uint32_t factor,
+                                                           const destination_format& format, const size_t stride,
+                                                           const span<std::byte> destination_pixels)
+{
+    if (format.float_samples_per_pixel == 0)
+    {
+        decode_scaled_pixels(region, factor, format, stride, destination_pixels);
+    }
+    else
+    {
+        decode_normalized_pixels(region, factor, format.float_samples_per_pixel, stride, destination_pixels);
+    }
+}
+
+void netpbm_bitmap_frame_decode::decode_normalized_pixels(const WICRect& region, const uint32_t factor,
+                                                          const uint32_t float_samples_per_pixel, const size_t stride,
+                                                          const span<std::byte> destination_pixels)
+{
+    // Bands of rows are decoded in the pixel format of the frame and normalized while they are still in the cache.
+    // Expanded RGB rows are normalized at the end of the destination rows and grow in place to RGBA.
+    const uint32_t samples_per_pixel{get_samples_per_pixel(header_.PnmType)};
+    const uint32_t bits_per_sample{bits_per_pixel_ / samples_per_pixel};
+    const float scale{1.0F / sample_converter_.convert(static_cast<uint16_t>(header_.MaxColorValue))};
+    const auto width{static_cast<uint32_t>(region.Width)};
+    const auto height{static_cast<uint32_t>(region.Height)};
+    const size_t expand_offset{float_samples_per_pixel == samples_per_pixel ? 0 : static_cast<size_t>(width)};
+    const uint32_t band_height{header_.AsciiFormat ? height : transform_band_height};
+    const size_t band_stride{compute_row_size(width, destination_format{})};
+    std::vector<std::byte> band(band_stride * std::min(band_height, height));
+    for (uint32_t y{}; y < height; y += band_height)
+    {
+        const uint32_t rows{std::min(band_height, height - y)};
+        const WICRect band_region{.X{region.X}, .Y{region.Y + static_cast<int32_t>(y)}, .Width{region.Width},
+                                  .Height{static_cast<int32_t>(rows)}};
+        decode_scaled_pixels(band_region, factor, {}, band_stride, {band.data(), band_stride * rows});
+
+        for (uint32_t row{}; row != rows; ++row)
+        {
+            auto* destination_row{reinterpret_cast<float*>(destination_pixels.data() + (y + row) * stride)};
+            convert_to_float({band.data() + row * band_stride, band_stride}, bits_per_sample, scale,
+                             destination_row + expand_offset);
+            if (expand_offset != 0)
+            {
+                expand_rgb_to_rgba(destination_row, width);
+            }
+        }
+    }
+}
+
+void netpbm_bitmap_frame_decode::decode_transformed_pixels(const WICRect& region, const uint32_t factor,
+                                                           const WICBitmapTransformOptions transform,
+                                                           const destination_format& format, const size_t stride,
+                                                           const span<std::byte> destination_pixels)
+{
+    const auto width{static_cast<uint32_t>(region.Width)};
+    const auto height{static_cast<uint32_t>(region.Height)};
+    const size_t pixel_size{compute_row_size(1, format)};
+    const auto [origin, column_step, row_step]{get_transform_layout(
+        transform, width, height, static_cast<ptrdiff_t>(pixel_size), static_cast<ptrdiff_t>(stride))};
+
+    const uint32_t band_height{header_.AsciiFormat ? height : transform_band_height};
+    const size_t band_stride{width * pixel_size};
+    std::vector<std::byte> band(band_stride * std::min(band_height, height));
+    for (uint32_t y{}; y < height; y += band_height)
+    {
+        const uint32_t rows{std::min(band_height, height - y)};
+        const WICRect band_region{.X{region.X}, .Y{region.Y + static_cast<int32_t>(y)}, .Width{region.Width},
+                                  .Height{static_cast<int32_t>(rows)}};
+        decode_destination_pixels(band_region, factor, format, band_stride, {band.data(), band_stride * rows});
+        copy_pixels_transformed(band.data(), band_stride, width, rows, pixel_size,
+                                destination_pixels.data() + origin + static_cast<ptrdiff_t>(y) * row_step, column_step,
+                                row_step);
+    }
+}
+
+void netpbm_bitmap_frame_decode::decode_planes(const WICRect& region, const uint32_t factor,
+                                               const WICBitmapTransformOptions transform,
+                                               const destination_format& format,
+                                               const span<const WICBitmapPlane> planes)
+{
+    // Bands of interleaved pixels are decoded and split into the planes while they are still in the cache. Rotated
+    // and flipped planes are split into bands of plane rows first.
+    const auto width{static_cast<uint32_t>(region.Width)};
+    const auto height{static_cast<uint32_t>(region.Height)};
+    const size_t pixel_size{compute_row_size(1, format)};
+    const size_t sample_size{pixel_size / planes.size()};
+    const uint32_t band_height{header_.AsciiFormat ? height : transform_band_height};
+    const size_t band_stride{width * pixel_size};
+    const size_t plane_band_stride{width * sample_size};
+    const size_t plane_band_size{plane_band_stride * std::min(band_height, height)};
+    std::vector<std::byte> band(band_stride * std::min(band_height, height));
+    std::vector<std::byte> plane_bands(transform == WICBitmapTransformRotate0 ? 0 : plane_band_size * planes.size());
+
+    std::array<std::byte*, 4> plane_rows{};
+    for (uint32_t y{}; y < height; y += band_height)
+    {
+        const uint32_t rows{std::min(band_height, height - y)};
+        const WICRect band_region{.X{region.X}, .Y{region.Y + static_cast<int32_t>(y)}, .Width{region.Width},
+                                  .Height{static_cast<int32_t>(rows)}};
+        decode_destination_pixels(band_region, factor, format, band_stride, {band.data(), band_stride * rows});
+
+        for (uint32_t row{}; row != rows; ++row)
+        {
+            for (size_t i{}; i != planes.size(); ++i)
+            {
+                plane_rows[i] = plane_bands.empty()
+                                    ? reinterpret_cast<std::byte*>(planes[i].pbBuffer) + (y + row) * planes[i].cbStride
+                                    : plane_bands.data() + i * plane_band_size + row * plane_band_stride;
+            }
+            deinterleave(band.data() + row * band_stride, width, planes.size(), sample_size, plane_rows.data());
+        }
+
+        if (plane_bands.empty())
+            continue;
+
+        for (size_t i{}; i != planes.size(); ++i)
+        {
+            const auto [origin, column_step, row_step]{get_transform_layout(
+                transform, width, height, static_cast<ptrdiff_t>(sample_size), static_cast<ptrdiff_t>(planes[i].cbStride))};
+            copy_pixels_transformed(plane_bands.data() + i * plane_band_size, plane_band_stride, width, rows, sample_size,
+                                    reinterpret_cast<std::byte*>(planes[i].pbBuffer) + origin +
+                                        static_cast<ptrdiff_t>(y) * row_step,
+                                    column_step, row_step);
+        }
+    }
+}
+
+winrt::com_ptr<IWICBitmapSource> netpbm_bitmap_frame_decode::create_thumbnail()
+{
+    // Every thumbnail pixel covers a block of factor x factor image pixels. Only a few rows in the middle of every block
+    // are read, the stream reader seeks past the other rows: I/O and CPU time scale with the size of the thumbnail.
+    const uint32_t factor{(std::max(header_.width, header_.height) + thumbnail_size - 1) / thumbnail_size};
+    const uint32_t width{(header_.width + factor - 1) / factor};
+    const uint32_t height{(header_.height + factor - 1) / factor};
+    const uint32_t samples_per_pixel{get_samples_per_pixel(header_.PnmType)};
+    const uint32_t bits_per_sample{bits_per_pixel_ / samples_per_pixel};
+    const size_t row_size{compute_row_size(header_.width, destination_format{})};
+    const size_t source_row_size{header_.PnmType == PnmType::Bitmap ? (header_.width + size_t{7}) / 8
+                                                                     : header_.width * get_source_pixel_size()};
+    const size_t thumbnail_stride{static_cast<size_t>(width) * samples_per_pixel};
+
+    // Decoded rows with 1, 2, 4 or 16 bit samples are scaled to 8 bits before they are box filtered.
+    const size_t row_sample_count{static_cast<size_t>(header_.width) * samples_per_pixel};
+    const size_t band_rows{std::min(factor, thumbnail_rows_per_block)};
+    buffered_stream_reader stream_reader{create_stream_reader(pixel_data_position_)};
+    std::vector<std::byte> band(row_size * band_rows);
+    std::vector<std::byte> band_8_bit(bits_per_sample == 8 ? 0 : row_sample_count * band_rows);
+    const size_t band_8_bit_stride{bits_per_sample == 8 ? row_size : row_sample_count};
+    std::vector<std::byte> pixels(thumbnail_stride * height);
+    for (uint32_t y{}, next_row{}; y != height; ++y)
+    {
+        const uint32_t block_height{std::min(factor, header_.height - y * factor)};
+        const uint32_t rows{std::min(block_height, thumbnail_rows_per_block)};
+        const uint32_t first_row{y * factor + (block_height - rows) / 2};
+        stream_reader.skip((first_row - next_row) * source_row_size);
+        decode_rows(stream_reader, header_.width, rows, {}, row_size, {band.data(), row_size * rows}, nullptr);
+        next_row = first_row + rows;
+
+        if (!band_8_bit.empty())
+        {
+            for (uint32_t row{}; row != rows; ++row)
+            {
+                convert_to_8_bit_samples(band.data() + row * row_size, row_sample_count, bits_per_sample,
+                                         band_8_bit.data() + row * row_sample_count);
+            }
+        }
+
+        downscale_rows(band_8_bit.empty() ? band.data() : band_8_bit.data(), band_8_bit_stride, rows, header_.width,
+                       factor, samples_per_pixel, 8, pixels.data() + y * thumbnail_stride);
+    }
+
+    com_ptr<IWICBitmap> bitmap;
+    check_hresult(imaging_factory_->get()->CreateBitmapFromMemory(
+        width, height, get_thumbnail_pixel_format(samples_per_pixel), static_cast<uint32_t>(thumbnail_stride),
+        static_cast<uint32_t>(pixels.size()), reinterpret_cast<BYTE*>(pixels.data()), bitmap.put()));
+    return bitmap.as<IWICBitmapSource>();
+}
+
+void netpbm_bitmap_frame_decode::decode_float_pixels(const WICRect& region, const size_t stride,
+                                                     const span<std::byte> destination_pixels)
+{
+    // PFM rows are stored bottom-up: the last row of the region is the first one in the stream.
+    const size_t pixel_size{header_.depth * sizeof(float)};
+    const size_t source_row_size{header_.width * pixel_size};
+    const size_t region_row_size{region.Width * pixel_size};
+    const size_t first_row{header_.height - static_cast<size_t>(region.Y) - region.Height};
+    buffered_stream_reader stream_reader{
+        create_stream_reader(pixel_data_position_ + first_row * source_row_size + region.X * pixel_size)};
+
+    for (size_t row{static_cast<size_t>(region.Height)}; row; --row)
+    {
+        std::byte* line{destination_pixels.data() + (row - 1) * stride};
+        stream_reader.read_bytes(line, region_row_size);
+        if (!header_.LittleEndian)
+        {
+            convert_to_little_endian({reinterpret_cast<float*>(line), region_row_size / sizeof(float)});
+        }
+
+        if (row != 1)
+        {
+            stream_reader.skip(source_row_size - region_row_size);
+        }
+    }
+}
+
+std::pair<int32_t, std::uint64_t> netpbm_bitmap_frame_decode::find_ascii_row_position(const int32_t row)
+{
+    std::scoped_lock lock{ascii_row_positions_mutex_};
+    const size_t index{
+        std::min(static_cast<size_t>(row / ascii_row_index_interval), ascii_row_positions_.size() - 1)};
+    return {static_cast<int32_t>(index) * ascii_row_index_interval, ascii_row_positions_[index]};
+}
+
+void netpbm_bitmap_frame_decode::record_ascii_row_position(const int32_t row, const std::uint64_t position)
+{
+    if (row % ascii_row_index_interval != 0)
+        return;
+
+    // Rows are parsed in order: only the position of the first row after the known positions can be new.
+    std::scoped_lock lock{ascii_row_positions_mutex_};
+    if (static_cast<size_t>(row / ascii_row_index_interval) == ascii_row_positions_.size())
+    {
+        ascii_row_positions_.push_back(position);
+    }
+}
+
+void netpbm_bitmap_frame_decode::decode_ascii_pixels(const WICRect& region, const destination_format& format,
+                                                     const size_t stride, const span<std::byte> destination_pixels)
+{
+    // ASCII rows don't have a fixed size: the rows between the nearest known row position and the region are parsed
+    // to find the start of the region.
+    const auto [first_row, first_row_position]{find_ascii_row_position(region.Y)};
+    buffered_stream_reader stream_reader{create_stream_reader(first_row_position)};
+    const int32_t end_row{region.Y + region.Height};
+
+    if (header_.PnmType == PnmType::Bitmap)
+    {
+        std::vector<std::byte> row_samples(header_.width);
+        for (int32_t row{first_row}; row != region.Y; ++row)
+        {
+            record_ascii_row_position(row, stream_reader.position());
+            read_ascii_bits(stream_reader, row_samples);
+        }
+
+        const auto region_samples{span{row_samples}.subspan(region.X, region.Width)};
+        for (int32_t row{}; row != region.Height; ++row)
+        {
+            record_ascii_row_position(region.Y + row, stream_reader.position());
+            read_ascii_bits(stream_reader, row_samples);
+            pack_to_bits(region_samples, destination_pixels.data() + row * stride);
+        }
+
+        record_ascii_row_position(end_row, stream_reader.position());
+        convert_rows_to_black_white(region.Width, region.Height, stride, destination_pixels);
+        return;
+    }
+
+    const size_t samples_per_pixel{header_.depth};
+    std::vector<uint16_t> row_samples(header_.width * samples_per_pixel);
+    for (int32_t row{first_row}; row != region.Y; ++row)
+    {
+        record_ascii_row_position(row, stream_reader.position());
+        read_ascii_samples(stream_reader, row_samples);
+    }
+
+    const auto region_samples{
+        span{row_samples}.subspan(region.X * samples_per_pixel, region.Width * samples_per_pixel)};
+    // Narrowed samples are rounded from the parsed samples directly to 8 bits.
+    const uint32_t bits_per_sample{format.narrow_to_8_bit ? 8U : bits_per_sample_};
+    const sample_converter converter{
+        format.narrow_to_8_bit ? sample_converter{8, 0, header_.MaxColorValue} : sample_converter_};
+    const size_t source_offset{get_bgr_source_offset(format.conversion, region.Width)};
+    for (int32_t row{}; row != region.Height; ++row)
+    {
+        std::byte* destination_row{destination_pixels.data() + row * stride};
+        record_ascii_row_position(region.Y + row, stream_reader.position());
+        read_ascii_samples(stream_reader, row_samples);
+        store_ascii_samples(region_samples, bits_per_sample, converter, destination_row + source_offset);
+        convert_to_bgr(format.conversion, destination_row, region.Width);
+    }
+
+    record_ascii_row_position(end_row, stream_reader.position());
+}
+
+void netpbm_bitmap_frame_decode::decode_bitmap_pixels(const WICRect& region, const size_t stride,
+                                                      const span<std::byte> destination_pixels)
+{
+    // Every bitmap row starts at a byte boundary, the region can start in the middle of a byte.
+    const size_t source_row_size{(header_.width + size_t{7}) / 8};
+    buffered_stream_reader stream_reader{
+        create_stream_reader(pixel_data_position_ + region.Y * source_row_size + region.X / 8)};
+
+    read_bitmap_rows(stream_reader, source_row_size, static_cast<size_t>(region.X) % 8, region.Width, region.Height,
+                     stride, destination_pixels);
+    convert_rows_to_black_white(region.Width, region.Height, stride, destination_pixels);
+}
+
+void netpbm_bitmap_frame_decode::decode_rows(buffered_stream_reader& stream_reader, const size_t width,
+                                             const size_t height, const destination_format& format,
+                                             const size_t stride, const span<std::byte> destination_pixels,
+                                             band_worker_pool* worker_pool) const
+{
+    if (format.narrow_to_8_bit)
+    {
+        read_and_narrow_rows(stream_reader, width, header_.depth, height, header_.MaxColorValue, stride,
+                             destination_pixels, worker_pool);
+        return;
+    }
+
+    switch (header_.PnmType)
+    {
+    case PnmType::Bitmap:
+        // Only complete rows: decode_bitmap_pixels shifts regions that don't start at a byte boundary.
+        read_rows(stream_reader, (width + 7) / 8, height, stride, destination_pixels);
+        convert_rows_to_black_white(width, height, stride, destination_pixels);
+        break;
+
+    case PnmType::Graymap:
+        decode_monochrome_bitmap(stream_reader, width, height, bits_per_sample_, sample_converter_, stride,
+                                 destination_pixels, worker_pool);
+        break;
+
+    case PnmType::Pixmap:
+        decode_color_bitmap(stream_reader, width, height, bits_per_sample_, sample_converter_, format.conversion,
+                            stride, destination_pixels, worker_pool);
+        break;
+
+    case PnmType::ArbitraryMap:
+        decode_pam_bitmap(stream_reader, width, height, header_.depth, bits_per_sample_, sample_converter_,
+                          format.conversion, stride, destination_pixels, worker_pool);
+        break;
+
+    default:
+        break;
+    }
+}
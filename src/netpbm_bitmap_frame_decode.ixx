@@ -11,18 +11,31 @@ import std;
 import <win.hpp>;
 import winrt_base;
 
+import band_worker_pool;
+import buffered_stream_reader;
+import memory_mapped_file;
+import pnm_header;
+import sample_conversion;
+import util;
+
 using std::uint32_t;
 
 export struct netpbm_bitmap_frame_decode
-    : winrt::implements<netpbm_bitmap_frame_decode, IWICBitmapFrameDecode, IWICBitmapSource>
+    : winrt::implements<netpbm_bitmap_frame_decode, IWICBitmapFrameDecode, IWICBitmapSource, IWICBitmapSourceTransform,
+                        IWICPlanarBitmapSourceTransform>
 {
-    netpbm_bitmap_frame_decode(_In_ IStream* source_stream, _In_ IWICImagingFactory* factory);
+    // The source stream is shared with the decoder and its other frames, the mutex serializes its use. The imaging
+    // factory of the decoder is reused to create thumbnails.
+    netpbm_bitmap_frame_decode(_In_ IStream* source_stream, std::shared_ptr<std::mutex> source_stream_mutex,
+                               std::shared_ptr<imaging_factory_cache> imaging_factory, const pnm_header& header,
+                               std::uint64_t pixel_data_position);
 
     // IWICBitmapSource
-    HRESULT __stdcall GetSize(uint32_t* width, uint32_t* height) override;
-    HRESULT __stdcall GetPixelFormat(GUID* pixel_format) override;
-    HRESULT __stdcall GetResolution(double* dpi_x, double* dpi_y) override;
-    HRESULT __stdcall CopyPixels(const WICRect* rectangle, uint32_t stride, uint32_t buffer_size, BYTE* buffer) override;
+    HRESULT __stdcall GetSize(uint32_t* width, uint32_t* height) noexcept override;
+    HRESULT __stdcall GetPixelFormat(GUID* pixel_format) noexcept override;
+    HRESULT __stdcall GetResolution(double* dpi_x, double* dpi_y) noexcept override;
+    HRESULT __stdcall CopyPixels(const WICRect* rectangle, uint32_t stride, uint32_t buffer_size,
+                                 BYTE* buffer) noexcept override;
     HRESULT __stdcall CopyPalette(IWICPalette*) noexcept override;
 
     // IWICBitmapFrameDecode : IWICBitmapSource
@@ -31,6 +44,83 @@ export struct netpbm_bitmap_frame_decode
                                        uint32_t* actual_count) noexcept override;
     HRESULT __stdcall GetMetadataQueryReader(IWICMetadataQueryReader** metadata_query_reader) noexcept override;
 
+    // IWICBitmapSourceTransform
+    HRESULT __stdcall CopyPixels(const WICRect* rectangle, uint32_t width, uint32_t height,
+                                 WICPixelFormatGUID* pixel_format, WICBitmapTransformOptions transform, uint32_t stride,
+                                 uint32_t buffer_size, BYTE* buffer) noexcept override;
+    HRESULT __stdcall GetClosestSize(uint32_t* width, uint32_t* height) noexcept override;
+    HRESULT __stdcall GetClosestPixelFormat(WICPixelFormatGUID* pixel_format) noexcept override;
+    HRESULT __stdcall DoesSupportTransform(WICBitmapTransformOptions transform, BOOL* is_supported) noexcept override;
+
+    // IWICPlanarBitmapSourceTransform
+    HRESULT __stdcall DoesSupportTransform(uint32_t* width, uint32_t* height, WICBitmapTransformOptions transform,
+                                           WICPlanarOptions planar_options, const WICPixelFormatGUID* pixel_formats,
+                                           WICBitmapPlaneDescription* plane_descriptions, uint32_t plane_count,
+                                           BOOL* is_supported) noexcept override;
+    HRESULT __stdcall CopyPixels(const WICRect* rectangle, uint32_t width, uint32_t height,
+                                 WICBitmapTransformOptions transform, WICPlanarOptions planar_options,
+                                 const WICBitmapPlane* planes, uint32_t plane_count) noexcept override;
+
 private:
-    winrt::com_ptr<IWICBitmapSource> bitmap_source_;
+    // The pixel format that is decoded by IWICBitmapSourceTransform: the pixel format of the frame, a BGR(A) format,
+    // 8 bit samples rounded from 16 bit samples or normalized floats.
+    struct destination_format final
+    {
+        bgr_conversion conversion;
+        uint32_t float_samples_per_pixel; // 0 when the samples are not normalized to floats.
+        bool narrow_to_8_bit;
+    };
+
+    [[nodiscard]] size_t compute_row_size(uint32_t width, const destination_format& format) const noexcept;
+    [[nodiscard]] uint32_t compute_scale_factor(uint32_t width, uint32_t height) const;
+    [[nodiscard]] std::optional<destination_format> get_destination_format(const GUID& pixel_format) const noexcept;
+    [[nodiscard]] std::optional<destination_format> get_plane_format(const GUID& pixel_format,
+                                                                     uint32_t plane_count) const noexcept;
+    void prepare_source_stream();
+    [[nodiscard]] size_t get_source_pixel_size() const noexcept;
+    [[nodiscard]] buffered_stream_reader create_stream_reader(std::uint64_t position);
+    [[nodiscard]] buffered_stream_reader create_region_reader(const WICRect& region);
+    [[nodiscard]] winrt::com_ptr<IStream> try_clone_source_stream();
+    [[nodiscard]] winrt::com_ptr<IWICBitmapSource> create_thumbnail();
+    void decode_pixels(const WICRect& region, const destination_format& format, size_t stride,
+                       std::span<std::byte> destination_pixels);
+    [[nodiscard]] bool try_decode_rows_in_parallel(const WICRect& region, const destination_format& format,
+                                                   size_t source_row_size, size_t stride,
+                                                   std::span<std::byte> destination_pixels);
+    void decode_scaled_pixels(const WICRect& region, uint32_t factor, const destination_format& format, size_t stride,
+                              std::span<std::byte> destination_pixels);
+    void decode_destination_pixels(const WICRect& region, uint32_t factor, const destination_format& format,
+                                   size_t stride, std::span<std::byte> destination_pixels);
+    void decode_normalized_pixels(const WICRect& region, uint32_t factor, uint32_t float_samples_per_pixel,
+                                  size_t stride, std::span<std::byte> destination_pixels);
+    void decode_transformed_pixels(const WICRect& region, uint32_t factor, WICBitmapTransformOptions transform,
+                                   const destination_format& format, size_t stride,
+                                   std::span<std::byte> destination_pixels);
+    void decode_planes(const WICRect& region, uint32_t factor, WICBitmapTransformOptions transform,
+                       const destination_format& format, std::span<const WICBitmapPlane> planes);
+    void decode_bitmap_pixels(const WICRect& region, size_t stride, std::span<std::byte> destination_pixels);
+    void decode_float_pixels(const WICRect& region, size_t stride, std::span<std::byte> destination_pixels);
+    [[nodiscard]] std::pair<std::int32_t, std::uint64_t> find_ascii_row_position(std::int32_t row);
+    void record_ascii_row_position(std::int32_t row, std::uint64_t position);
+    void decode_ascii_pixels(const WICRect& region, const destination_format& format, size_t stride,
+                             std::span<std::byte> destination_pixels);
+    void decode_rows(buffered_stream_reader& stream_reader, size_t width, size_t height,
+                     const destination_format& format, size_t stride, std::span<std::byte> destination_pixels,
+                     band_worker_pool* worker_pool) const;
+
+    winrt::com_ptr<IStream> source_stream_;
+    std::shared_ptr<std::mutex> source_stream_mutex_;
+    std::shared_ptr<imaging_factory_cache> imaging_factory_;
+    winrt::com_ptr<IStream> clone_source_; // Empty when the stream cannot be cloned.
+    memory_mapped_file mapped_file_;
+    bool source_stream_prepared_{};
+    pnm_header header_;
+    GUID pixel_format_;
+    uint32_t bits_per_sample_;
+    sample_converter sample_converter_;
+    uint32_t bits_per_pixel_;
+    std::uint64_t pixel_data_position_;
+    std::mutex clone_mutex_;
+    std::vector<std::uint64_t> ascii_row_positions_; // The stream position of every 64th row, recorded while parsed.
+    std::mutex ascii_row_positions_mutex_;
 };
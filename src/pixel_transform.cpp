@@ -0,0 +1,187 @@
+// SPDX-FileCopyrightText: © 2026 Team CharLS
+// SPDX-License-Identifier: BSD-3-Clause
+
+module pixel_transform;
+
+import std;
+import "macros.hpp";
+
+using std::ptrdiff_t;
+using std::size_t;
+using std::uint16_t;
+using std::uint32_t;
+
+namespace {
+
+// Number of columns copied from every row before moving to the next row. When the image is transposed the
+// destination rows of a block stay in the cache while the block is written.
+constexpr size_t block_width{32};
+
+template<size_t PixelSize>
+void copy_pixels_transformed(const std::byte* source, const size_t source_stride, const size_t width,
+                             const size_t height, std::byte* destination, const ptrdiff_t column_step,
+                             const ptrdiff_t row_step) noexcept
+{
+    using pixel = std::array<std::byte, PixelSize>;
+
+    if (column_step == static_cast<ptrdiff_t>(PixelSize))
+    {
+        for (size_t y{}; y != height; ++y)
+        {
+            std::memcpy(destination + static_cast<ptrdiff_t>(y) * row_step, source + y * source_stride,
+                        width * PixelSize);
+        }
+        return;
+    }
+
+    for (size_t block_x{}; block_x < width; block_x += block_width)
+    {
+        const size_t block_end{std::min(block_x + block_width, width)};
+        for (size_t y{}; y != height; ++y)
+        {
+            const auto* source_row{reinterpret_cast<const pixel*>(source + y * source_stride)};
+            std::byte* destination_row{destination + static_cast<ptrdiff_t>(y) * row_step};
+            for (size_t x{block_x}; x != block_end; ++x)
+            {
+                *reinterpret_cast<pixel*>(destination_row + static_cast<ptrdiff_t>(x) * column_step) = source_row[x];
+            }
+        }
+    }
+}
+
+template<typename Sample>
+void downscale_rows(const std::byte* source, const size_t source_stride, const size_t rows, const size_t width,
+                    const size_t factor, const size_t samples_per_pixel, std::byte* destination) noexcept
+{
+    using accumulator = std::conditional_t<std::is_floating_point_v<Sample>, double, std::uint64_t>;
+
+    auto* destination_samples{reinterpret_cast<Sample*>(destination)};
+    const size_t destination_width{(width + factor - 1) / factor};
+    for (size_t x{}; x != destination_width; ++x)
+    {
+        const size_t first{x * factor};
+        const size_t last{std::min(first + factor, width)};
+        const auto count{static_cast<accumulator>((last - first) * rows)};
+
+        for (size_t component{}; component != samples_per_pixel; ++component)
+        {
+            accumulator sum{};
+            for (size_t row{}; row != rows; ++row)
+            {
+                const auto* source_samples{reinterpret_cast<const Sample*>(source + row * source_stride)};
+                for (size_t i{first}; i != last; ++i)
+                {
+                    sum += source_samples[i * samples_per_pixel + component];
+                }
+            }
+
+            if constexpr (std::is_floating_point_v<Sample>)
+            {
+                destination_samples[x * samples_per_pixel + component] = static_cast<Sample>(sum / count);
+            }
+            else
+            {
+                destination_samples[x * samples_per_pixel + component] = static_cast<Sample>((sum + count / 2) / count);
+            }
+        }
+    }
+}
+
+} // namespace
+
+
+void copy_pixels_transformed(const std::byte* source, const size_t source_stride, const size_t width,
+                             const size_t height, const size_t pixel_size, std::byte* destination,
+                             const ptrdiff_t column_step, const ptrdiff_t row_step) noexcept
+{
+    switch (pixel_size)
+    {
+    case 1:
+        copy_pixels_transformed<1>(source, source_stride, width, height, destination, column_step, row_step);
+        break;
+
+    case 2:
+        copy_pixels_transformed<2>(source, source_stride, width, height, destination, column_step, row_step);
+        break;
+
+    case 3:
+        copy_pixels_transformed<3>(source, source_stride, width, height, destination, column_step, row_step);
+        break;
+
+    case 4:
+        copy_pixels_transformed<4>(source, source_stride, width, height, destination, column_step, row_step);
+        break;
+
+    case 6:
+        copy_pixels_transformed<6>(source, source_stride, width, height, destination, column_step, row_step);
+        break;
+
+    case 8:
+        copy_pixels_transformed<8>(source, source_stride, width, height, destination, column_step, row_step);
+        break;
+
+    case 12:
+        copy_pixels_transformed<12>(source, source_stride, width, height, destination, column_step, row_step);
+        break;
+
+    default:
+        ASSERT(pixel_size == 16);
+        copy_pixels_transformed<16>(source, source_stride, width, height, destination, column_step, row_step);
+        break;
+    }
+}
+
+void downscale_rows(const std::byte* source, const size_t source_stride, const size_t rows, const size_t width,
+                    const size_t factor, const size_t samples_per_pixel, const uint32_t bits_per_sample,
+                    std::byte* destination) noexcept
+{
+    switch (bits_per_sample)
+    {
+    case 8:
+        downscale_rows<std::uint8_t>(source, source_stride, rows, width, factor, samples_per_pixel, destination);
+        break;
+
+    case 16:
+        downscale_rows<uint16_t>(source, source_stride, rows, width, factor, samples_per_pixel, destination);
+        break;
+
+    default:
+        ASSERT(bits_per_sample == 32);
+        downscale_rows<float>(source, source_stride, rows, width, factor, samples_per_pixel, destination);
+        break;
+    }
+}
+
+void convert_to_8_bit_samples(const std::byte* source, const size_t count, const uint32_t bits_per_sample,
+                              std::byte* destination) noexcept
+{
+    switch (bits_per_sample)
+    {
+    case 16: {
+        // Rounded to the nearest value, the same as 16 bit samples that are decoded to an 8 bit pixel format.
+        const auto* samples{reinterpret_cast<const uint16_t*>(source)};
+        for (size_t i{}; i != count; ++i)
+        {
+            destination[i] = static_cast<std::byte>((samples[i] * 255U + 32767) / 65535);
+        }
+        break;
+    }
+
+    case 8:
+        std::memcpy(destination, source, count);
+        break;
+
+    default: {
+        ASSERT(bits_per_sample == 1 || bits_per_sample == 2 || bits_per_sample == 4);
+        const uint32_t max_value{(1U << bits_per_sample) - 1};
+        for (size_t i{}; i != count; ++i)
+        {
+            const size_t bit_position{i * bits_per_sample};
+            const auto shift{static_cast<uint32_t>(8 - bits_per_sample - bit_position % 8)};
+            const uint32_t sample{(std::to_integer<uint32_t>(source[bit_position / 8]) >> shift) & max_value};
+            destination[i] = static_cast<std::byte>(sample * 255 / max_value);
+        }
+        break;
+    }
+    }
+}
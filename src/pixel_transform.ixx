@@ -0,0 +1,27 @@
+// SPDX-FileCopyrightText: © 2026 Team CharLS
+// SPDX-License-Identifier: BSD-3-Clause
+
+export module pixel_transform;
+
+import std;
+
+export {
+
+// Copies width x height pixels of pixel_size bytes: source pixel (x, y) is stored at
+// destination + x * column_step + y * row_step. Negative steps flip the image, a column step that is a multiple of the
+// destination stride transposes it (used to rotate by 90 or 270 degrees).
+void copy_pixels_transformed(const std::byte* source, size_t source_stride, size_t width, size_t height,
+                             size_t pixel_size, std::byte* destination, std::ptrdiff_t column_step,
+                             std::ptrdiff_t row_step) noexcept;
+
+// Box filters a band of rows into one destination row: every destination pixel is the average of factor source pixels
+// of all rows in the band. Samples are 8 or 16 bit unsigned integers or 32 bit floats (bits_per_sample 32).
+void downscale_rows(const std::byte* source, size_t source_stride, size_t rows, size_t width, size_t factor,
+                    size_t samples_per_pixel, std::uint32_t bits_per_sample, std::byte* destination) noexcept;
+
+// Scales count samples of 1, 2, 4, 8 or 16 bits to 8 bits. Samples with less than 8 bits are packed, starting at the
+// high bits.
+void convert_to_8_bit_samples(const std::byte* source, size_t count, std::uint32_t bits_per_sample,
+                              std::byte* destination) noexcept;
+
+}
@@ -26,6 +26,24 @@ export enum class PnmType
     ArbitraryMap
 };
 
+// Returns the number of samples per pixel of a PAM tuple type, or 0 when the tuple type is not supported.
+[[nodiscard]] uint32_t get_tuple_type_depth(const std::string_view tuple_type) noexcept
+{
+    if (tuple_type == "GRAYSCALE")
+        return 1;
+
+    if (tuple_type == "GRAYSCALE_ALPHA")
+        return 2;
+
+    if (tuple_type == "RGB")
+        return 3;
+
+    if (tuple_type == "RGB_ALPHA")
+        return 4;
+
+    return 0;
+}
+
 export bool is_pnm_file(_In_ IStream* stream)
 {
     char magic[2];
@@ -33,15 +51,19 @@ export bool is_pnm_file(_In_ IStream* stream)
     unsigned long read;
     check_hresult(stream->Read(magic, sizeof magic, &read), wincodec::error_stream_read);
 
-    return read == sizeof magic && magic[0] == 'P' && (magic[1] == '5' || magic[1] == '6' || magic[1] == '7');
+    return read == sizeof magic && magic[0] == 'P' &&
+           ((magic[1] >= '1' && magic[1] <= '7') || magic[1] == 'F' || magic[1] == 'f');
 }
 
 export struct pnm_header
 {
     PnmType PnmType;
     bool AsciiFormat;
+    bool FloatFormat;
+    bool LittleEndian;
     uint32_t width;
     uint32_t height;
+    uint32_t depth;
     USHORT MaxColorValue;
 
     pnm_header() = default;
@@ -51,6 +73,16 @@ export struct pnm_header
         winrt::check_hresult(Parse(streamReader));
     }
 
+    // Returns the size in bytes of the pixel data of a binary image, the next image in a stream starts directly after it.
+    [[nodiscard]] std::uint64_t raster_size() const noexcept
+    {
+        if (PnmType == PnmType::Bitmap)
+            return (static_cast<std::uint64_t>(width) + 7) / 8 * height;
+
+        const uint32_t bytes_per_sample{FloatFormat ? 4U : MaxColorValue > 255 ? 2U : 1U};
+        return static_cast<std::uint64_t>(width) * height * depth * bytes_per_sample;
+    }
+
     HRESULT Parse(buffered_stream_reader& streamReader)
     {
         char magic[2];
@@ -64,6 +96,8 @@ export struct pnm_header
             throw_hresult(wincodec::error_bad_header);
 
         AsciiFormat = false;
+        FloatFormat = false;
+        LittleEndian = false;
 
         switch (magic[1])
         {
@@ -87,6 +121,14 @@ export struct pnm_header
             break;
         case '7': // P7: PAM (Portable Arbitrary Map)
             return ParsePamHeader(streamReader);
+        case 'f': // Pf: PFM (Portable Float Map), gray scale
+            FloatFormat = true;
+            PnmType = PnmType::Graymap;
+            break;
+        case 'F': // PF: PFM (Portable Float Map), RGB
+            FloatFormat = true;
+            PnmType = PnmType::Pixmap;
+            break;
 
         default:
             throw_hresult(wincodec::error_bad_header);
@@ -98,6 +140,11 @@ export struct pnm_header
         if (width < 1 || height < 1)
             return wincodec::error_bad_header;
 
+        depth = PnmType == PnmType::Pixmap ? 3 : 1;
+
+        if (FloatFormat)
+            return ParseFloatScale(streamReader);
+
         int maxColorValue;
 
         if (PnmType != PnmType::Bitmap)
@@ -115,8 +162,29 @@ export struct pnm_header
         return success_ok;
     }
 
+    HRESULT ParseFloatScale(buffered_stream_reader& streamReader)
+    {
+        // The sign of the scale gives the byte order of the samples, the magnitude is not used to decode the pixels.
+        char scale_buffer[32];
+        streamReader.read_string(scale_buffer, sizeof scale_buffer);
+
+        float scale;
+        if (const auto [ptr, ec] = std::from_chars(scale_buffer, std::end(scale_buffer), scale);
+            ec != std::errc() || scale == 0 || !std::isfinite(scale))
+            return wincodec::error_bad_header;
+
+        LittleEndian = scale < 0;
+        MaxColorValue = 0;
+        return success_ok;
+    }
+
     HRESULT ParsePamHeader(buffered_stream_reader& streamReader)
     {
+        width = 0;
+        height = 0;
+        depth = 0;
+        MaxColorValue = 0;
+        uint32_t tuple_type_depth{};
         char token_buffer[9];
 
         for (;;)
@@ -124,7 +192,7 @@ export struct pnm_header
             streamReader.read_string(token_buffer, 9);
             std::string_view token{token_buffer};
             if (token == "ENDHDR")
-                return success_ok;
+                break;
 
             if (token == "HEIGHT")
             {
@@ -136,24 +204,46 @@ export struct pnm_header
             }
             else if (token == "DEPTH")
             {
-                int depth = streamReader.read_int();
-                if (depth != 4)
-                    winrt::throw_hresult(wincodec::error_bad_header);
-
-                PnmType = PnmType::ArbitraryMap;
+                depth = streamReader.read_int();
             }
             else if (token == "MAXVAL")
             {
-                MaxColorValue = static_cast<USHORT>(streamReader.read_int());
+                const uint32_t max_value{streamReader.read_int()};
+                if (max_value < 1 || max_value > 65535)
+                    return wincodec::error_bad_header;
+
+                MaxColorValue = static_cast<USHORT>(max_value);
             }
             else if (token == "TUPLTYPE")
             {
                 char tupletype_buffer[17];
                 streamReader.read_string(tupletype_buffer, 16);
-                std::string_view tupletype{tupletype_buffer};
-                if (tupletype != "RGB_ALPHA")
+                tuple_type_depth = get_tuple_type_depth(tupletype_buffer);
+                if (tuple_type_depth == 0)
                     winrt::throw_hresult(wincodec::error_bad_header);
             }
         }
+
+        if (width < 1 || height < 1 || depth < 1 || depth > 4 || MaxColorValue < 1 ||
+            (tuple_type_depth != 0 && tuple_type_depth != depth))
+            return wincodec::error_bad_header;
+
+        // Without an alpha channel the pixels are stored in the same layout as a binary graymap or pixmap.
+        switch (depth)
+        {
+        case 1:
+            PnmType = PnmType::Graymap;
+            break;
+
+        case 3:
+            PnmType = PnmType::Pixmap;
+            break;
+
+        default:
+            PnmType = PnmType::ArbitraryMap;
+            break;
+        }
+
+        return success_ok;
     }
 };
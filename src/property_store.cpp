@@ -45,7 +45,7 @@ const Value* find(span<const Key, Extent> keys, span<Value, Extent> values, cons
     return nullptr;
 }
 
-[[nodiscard]] uint32_t compute_bit_depth(const PnmType type, const uint32_t max_value) noexcept
+[[nodiscard]] uint32_t compute_bit_depth(const PnmType type, const uint32_t depth, const uint32_t max_value) noexcept
 {
     switch (type)
     {
@@ -59,7 +59,7 @@ const Value* find(span<const Key, Extent> keys, span<Value, Extent> values, cons
         return std::bit_width(max_value) * 3;
 
     case PnmType::ArbitraryMap:
-        return std::bit_width(max_value) * 4;
+        return std::bit_width(max_value) * depth;
     }
 
     std::unreachable();
@@ -83,7 +83,8 @@ struct property_store : winrt::implements<property_store, IInitializeWithStream,
 
         property_values_[0] = property_variant{header.width};
         property_values_[1] = property_variant{header.height};
-        property_values_[2] = property_variant{compute_bit_depth(header.PnmType, header.MaxColorValue)};
+        property_values_[2] = property_variant{
+            header.FloatFormat ? 32 * header.depth : compute_bit_depth(header.PnmType, header.depth, header.MaxColorValue)};
         property_values_[3] = property_variant{(to_wstring(header.width) + L" x " + to_wstring(header.height)).c_str()};
         property_values_[4] = property_variant{static_cast<std::uint16_t>(IMAGE_COMPRESSION_UNCOMPRESSED)};
 
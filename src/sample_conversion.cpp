@@ -0,0 +1,1650 @@
+// SPDX-FileCopyrightText: © 2026 Team CharLS
+// SPDX-License-Identifier: BSD-3-Clause
+
+module;
+
+#if defined(_M_IX86) || defined(_M_X64)
+#include <intrin.h>
+#include <immintrin.h>
+#elif defined(_M_ARM64)
+#include <arm64_neon.h>
+#endif
+
+module sample_conversion;
+
+import std;
+
+using std::size_t;
+using std::span;
+using std::uint16_t;
+using std::uint32_t;
+
+namespace {
+
+using convert_to_little_endian_and_shift_function = void (*)(uint16_t* samples, size_t count,
+                                                             uint32_t sample_shift) noexcept;
+using pack_function = void (*)(const std::byte* samples, size_t count, std::byte* destination) noexcept;
+using swizzle_function = void (*)(const std::byte* source, size_t count, std::byte* destination) noexcept;
+using deinterleave_function = void (*)(const std::byte* pixels, size_t count, std::byte* const* planes) noexcept;
+
+void byte_swap_and_shift_scalar(uint16_t* samples, const size_t count, const uint32_t sample_shift) noexcept
+{
+    for (size_t i{}; i != count; ++i)
+    {
+        samples[i] = static_cast<uint16_t>(std::byteswap(samples[i]) << sample_shift);
+    }
+}
+
+// Rescales to the full 16 bit range, rounded to the nearest value: (sample * 65535 + max_value / 2) / max_value.
+void byte_swap_and_scale_scalar(uint16_t* samples, const size_t count, const uint16_t max_value) noexcept
+{
+    for (size_t i{}; i != count; ++i)
+    {
+        const uint32_t sample{std::min(std::byteswap(samples[i]), max_value)};
+        samples[i] = static_cast<uint16_t>((sample * 65535U + max_value / 2U) / max_value);
+    }
+}
+
+// Rounds to the nearest 8 bit value: (sample * 255 + max_value / 2) / max_value.
+void byte_swap_and_narrow_scalar(const uint16_t* samples, const size_t count, const uint16_t max_value,
+                                 std::uint8_t* destination) noexcept
+{
+    for (size_t i{}; i != count; ++i)
+    {
+        const uint32_t sample{std::min(std::byteswap(samples[i]), max_value)};
+        destination[i] = static_cast<std::uint8_t>((sample * 255U + max_value / 2U) / max_value);
+    }
+}
+
+// Constants to divide any 32 bit value by max_value with a multiply and 2 shifts (Granlund and Montgomery).
+struct scale_divisor final
+{
+    uint32_t multiplier;
+    uint32_t shift1;
+    uint32_t shift2;
+};
+
+[[nodiscard]] scale_divisor create_scale_divisor(const uint16_t max_value) noexcept
+{
+    const auto log2{static_cast<uint32_t>(std::bit_width(max_value - 1U))};
+    return {static_cast<uint32_t>((uint64_t{1} << 32) * ((uint64_t{1} << log2) - max_value) / max_value + 1),
+            std::min(log2, 1U), log2 == 0 ? 0 : log2 - 1};
+}
+
+void pack_crumbs_scalar(const std::byte* samples, const size_t count, std::byte* destination) noexcept
+{
+    size_t i{};
+    for (; i + 4 <= count; i += 4)
+    {
+        *destination++ = samples[i] << 6 | samples[i + 1] << 4 | samples[i + 2] << 2 | samples[i + 3];
+    }
+
+    // WIC stores the first pixel in the most significant bits, also for a partial byte at the end of a row.
+    if (i != count)
+    {
+        std::byte value{};
+        for (int shift{6}; i != count; ++i, shift -= 2)
+        {
+            value |= samples[i] << shift;
+        }
+        *destination = value;
+    }
+}
+
+void pack_nibbles_scalar(const std::byte* samples, const size_t count, std::byte* destination) noexcept
+{
+    size_t i{};
+    for (; i + 2 <= count; i += 2)
+    {
+        *destination++ = samples[i] << 4 | samples[i + 1];
+    }
+
+    if (i != count)
+    {
+        *destination = samples[i] << 4;
+    }
+}
+
+// The swizzle kernels convert count pixels from source to destination. Source and destination may overlap when every
+// source pixel is read before its bytes are overwritten: in place, or with 3 byte pixels stored after 4 byte pixels.
+
+void swap_rgb_scalar(const std::byte* source, const size_t count, std::byte* destination) noexcept
+{
+    for (size_t i{}; i != count; ++i)
+    {
+        const std::byte red{source[i * 3]};
+        const std::byte green{source[i * 3 + 1]};
+        const std::byte blue{source[i * 3 + 2]};
+        destination[i * 3] = blue;
+        destination[i * 3 + 1] = green;
+        destination[i * 3 + 2] = red;
+    }
+}
+
+void rgb_to_bgra_scalar(const std::byte* source, const size_t count, std::byte* destination) noexcept
+{
+    for (size_t i{}; i != count; ++i)
+    {
+        const std::byte red{source[i * 3]};
+        const std::byte green{source[i * 3 + 1]};
+        const std::byte blue{source[i * 3 + 2]};
+        destination[i * 4] = blue;
+        destination[i * 4 + 1] = green;
+        destination[i * 4 + 2] = red;
+        destination[i * 4 + 3] = std::byte{0xFF};
+    }
+}
+
+void swap_rgba_scalar(const std::byte* source, const size_t count, std::byte* destination) noexcept
+{
+    for (size_t i{}; i != count; ++i)
+    {
+        const std::byte red{source[i * 4]};
+        const std::byte blue{source[i * 4 + 2]};
+        destination[i * 4] = blue;
+        destination[i * 4 + 1] = source[i * 4 + 1];
+        destination[i * 4 + 2] = red;
+        destination[i * 4 + 3] = source[i * 4 + 3];
+    }
+}
+
+// Exact rounding of color * alpha / 255: (x + 128 + ((x + 128) >> 8)) >> 8 equals round(x / 255) for x <= 255 * 255.
+[[nodiscard]] constexpr std::byte premultiply(const std::byte color, const std::byte alpha) noexcept
+{
+    const uint32_t product{std::to_integer<uint32_t>(color) * std::to_integer<uint32_t>(alpha) + 128};
+    return static_cast<std::byte>((product + (product >> 8)) >> 8);
+}
+
+void swap_and_premultiply_rgba_scalar(const std::byte* source, const size_t count, std::byte* destination) noexcept
+{
+    for (size_t i{}; i != count; ++i)
+    {
+        const std::byte red{source[i * 4]};
+        const std::byte green{source[i * 4 + 1]};
+        const std::byte blue{source[i * 4 + 2]};
+        const std::byte alpha{source[i * 4 + 3]};
+        destination[i * 4] = premultiply(blue, alpha);
+        destination[i * 4 + 1] = premultiply(green, alpha);
+        destination[i * 4 + 2] = premultiply(red, alpha);
+        destination[i * 4 + 3] = alpha;
+    }
+}
+
+template<typename Sample>
+void normalize_scalar(const Sample* samples, const size_t count, const float scale, float* destination) noexcept
+{
+    for (size_t i{}; i != count; ++i)
+    {
+        destination[i] = std::min(static_cast<float>(samples[i]) * scale, 1.0F);
+    }
+}
+
+void expand_rgb_scalar(const float* source, const size_t count, float* destination) noexcept
+{
+    for (size_t i{}; i != count; ++i)
+    {
+        const float red{source[i * 3]};
+        const float green{source[i * 3 + 1]};
+        const float blue{source[i * 3 + 2]};
+        destination[i * 4] = red;
+        destination[i * 4 + 1] = green;
+        destination[i * 4 + 2] = blue;
+        destination[i * 4 + 3] = 1.0F;
+    }
+}
+
+// Copies the samples of pixels [first, count) to their planes.
+template<typename Sample>
+void deinterleave_samples(const std::byte* pixels, const size_t first, const size_t count,
+                          const size_t samples_per_pixel, std::byte* const* planes) noexcept
+{
+    const auto* samples{reinterpret_cast<const Sample*>(pixels)};
+    for (size_t plane{}; plane != samples_per_pixel; ++plane)
+    {
+        auto* plane_samples{reinterpret_cast<Sample*>(planes[plane])};
+        for (size_t i{first}; i != count; ++i)
+        {
+            plane_samples[i] = samples[i * samples_per_pixel + plane];
+        }
+    }
+}
+
+void deinterleave_rgb_scalar(const std::byte* pixels, const size_t count, std::byte* const* planes) noexcept
+{
+    deinterleave_samples<std::uint8_t>(pixels, 0, count, 3, planes);
+}
+
+void deinterleave_rgba_scalar(const std::byte* pixels, const size_t count, std::byte* const* planes) noexcept
+{
+    deinterleave_samples<std::uint8_t>(pixels, 0, count, 4, planes);
+}
+
+// The largest sample value (65535) has 5 digits, not counting leading zeros.
+constexpr size_t max_sample_digits{5};
+
+[[nodiscard]] constexpr bool is_ascii_whitespace(const std::byte c) noexcept
+{
+    return c == std::byte{' '} || (c >= std::byte{'\t'} && c <= std::byte{'\r'});
+}
+
+[[nodiscard]] constexpr bool is_ascii_digit(const std::byte c) noexcept
+{
+    return c >= std::byte{'0'} && c <= std::byte{'9'};
+}
+
+// Returns the number of digits without the leading zeros: 000255 is a valid sample.
+[[nodiscard]] size_t count_significant_digits(const std::byte* digits, const size_t length) noexcept
+{
+    size_t leading_zeros{};
+    while (leading_zeros + 1 < length && digits[leading_zeros] == std::byte{'0'})
+    {
+        ++leading_zeros;
+    }
+
+    return length - leading_zeros;
+}
+
+[[nodiscard]] bool parse_sample(const std::byte* digits, const size_t length, uint16_t& sample) noexcept
+{
+    const size_t significant_digits{count_significant_digits(digits, length)};
+    if (significant_digits > max_sample_digits)
+        return false;
+
+    digits += length - significant_digits;
+    uint32_t value{};
+    for (size_t i{}; i != significant_digits; ++i)
+    {
+        value = value * 10 + (std::to_integer<uint32_t>(digits[i]) - '0');
+    }
+
+    if (value > std::numeric_limits<uint16_t>::max())
+        return false;
+
+    sample = static_cast<uint16_t>(value);
+    return true;
+}
+
+#if defined(_M_IX86) || defined(_M_X64)
+
+struct cpu_features final
+{
+    bool ssse3;
+    bool avx2;
+    bool avx512bw;
+};
+
+[[nodiscard]] cpu_features detect_cpu_features() noexcept
+{
+    int info[4];
+    __cpuid(info, 0);
+    const int max_function_id{info[0]};
+
+    __cpuid(info, 1);
+    const bool ssse3{(info[2] & (1 << 9)) != 0};
+    const bool os_xsave{(info[2] & (1 << 27)) != 0};
+    const bool avx{(info[2] & (1 << 28)) != 0};
+
+    // The OS must save the YMM (and ZMM) registers on a context switch before AVX2 (and AVX-512) can be used.
+    const unsigned long long xcr0{os_xsave ? _xgetbv(0) : 0};
+    const bool os_ymm_support{(xcr0 & 0x06) == 0x06};
+    const bool os_zmm_support{(xcr0 & 0xE6) == 0xE6};
+
+    bool avx2{};
+    bool avx512bw{};
+    if (max_function_id >= 7)
+    {
+        __cpuidex(info, 7, 0);
+        avx2 = avx && os_ymm_support && (info[1] & (1 << 5)) != 0;
+        avx512bw = avx2 && os_zmm_support && (info[1] & (1 << 16)) != 0 && (info[1] & (1 << 30)) != 0;
+    }
+
+    return {.ssse3{ssse3}, .avx2{avx2}, .avx512bw{avx512bw}};
+}
+
+void byte_swap_and_shift_ssse3(uint16_t* samples, const size_t count, const uint32_t sample_shift) noexcept
+{
+    const __m128i swap_mask{_mm_setr_epi8(1, 0, 3, 2, 5, 4, 7, 6, 9, 8, 11, 10, 13, 12, 15, 14)};
+    const __m128i shift{_mm_cvtsi32_si128(static_cast<int>(sample_shift))};
+
+    size_t i{};
+    for (; i + 8 <= count; i += 8)
+    {
+        auto* address{reinterpret_cast<__m128i*>(samples + i)};
+        _mm_storeu_si128(address, _mm_sll_epi16(_mm_shuffle_epi8(_mm_loadu_si128(address), swap_mask), shift));
+    }
+
+    byte_swap_and_shift_scalar(samples + i, count - i, sample_shift);
+}
+
+void byte_swap_and_shift_avx2(uint16_t* samples, const size_t count, const uint32_t sample_shift) noexcept
+{
+    // pshufb works per 128 bit lane: the mask is repeated for both lanes.
+    const __m256i swap_mask{_mm256_setr_epi8(1, 0, 3, 2, 5, 4, 7, 6, 9, 8, 11, 10, 13, 12, 15, 14, 1, 0, 3, 2, 5, 4, 7,
+                                             6, 9, 8, 11, 10, 13, 12, 15, 14)};
+    const __m128i shift{_mm_cvtsi32_si128(static_cast<int>(sample_shift))};
+
+    size_t i{};
+    for (; i + 16 <= count; i += 16)
+    {
+        auto* address{reinterpret_cast<__m256i*>(samples + i)};
+        _mm256_storeu_si256(address,
+                            _mm256_sll_epi16(_mm256_shuffle_epi8(_mm256_loadu_si256(address), swap_mask), shift));
+    }
+
+    _mm256_zeroupper();
+    byte_swap_and_shift_scalar(samples + i, count - i, sample_shift);
+}
+
+void byte_swap_and_shift_avx512(uint16_t* samples, const size_t count, const uint32_t sample_shift) noexcept
+{
+    const __m512i swap_mask{
+        _mm512_broadcast_i32x4(_mm_setr_epi8(1, 0, 3, 2, 5, 4, 7, 6, 9, 8, 11, 10, 13, 12, 15, 14))};
+    const __m128i shift{_mm_cvtsi32_si128(static_cast<int>(sample_shift))};
+
+    size_t i{};
+    for (; i + 32 <= count; i += 32)
+    {
+        void* address{samples + i};
+        _mm512_storeu_si512(address, _mm512_sll_epi16(_mm512_shuffle_epi8(_mm512_loadu_si512(address), swap_mask), shift));
+    }
+
+    // Use a masked load and store for the remaining samples, this avoids a scalar tail loop.
+    if (const size_t remaining{count - i}; remaining != 0)
+    {
+        const __mmask32 mask{(1U << remaining) - 1};
+        const __m512i tail{_mm512_maskz_loadu_epi16(mask, samples + i)};
+        _mm512_mask_storeu_epi16(samples + i, mask, _mm512_sll_epi16(_mm512_shuffle_epi8(tail, swap_mask), shift));
+    }
+
+    _mm256_zeroupper();
+}
+
+// pmaddubsw multiplies unsigned samples with signed weights and adds adjacent pairs into 16 bit lanes:
+// (s0 * 4 + s1) for crumbs and (s0 * 16 + s1) for nibbles. pmaddwd combines 2 crumb pairs into 1 byte value.
+
+void pack_crumbs_ssse3(const std::byte* samples, const size_t count, std::byte* destination) noexcept
+{
+    const __m128i pair_weights{_mm_set1_epi16(0x0104)};
+    const __m128i quad_weights{_mm_set1_epi32(0x00010010)};
+
+    size_t i{};
+    for (; i + 64 <= count; i += 64)
+    {
+        const auto* source{reinterpret_cast<const __m128i*>(samples + i)};
+        const __m128i quads0{_mm_madd_epi16(_mm_maddubs_epi16(_mm_loadu_si128(source), pair_weights), quad_weights)};
+        const __m128i quads1{_mm_madd_epi16(_mm_maddubs_epi16(_mm_loadu_si128(source + 1), pair_weights), quad_weights)};
+        const __m128i quads2{_mm_madd_epi16(_mm_maddubs_epi16(_mm_loadu_si128(source + 2), pair_weights), quad_weights)};
+        const __m128i quads3{_mm_madd_epi16(_mm_maddubs_epi16(_mm_loadu_si128(source + 3), pair_weights), quad_weights)};
+
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(destination + i / 4),
+                         _mm_packus_epi16(_mm_packs_epi32(quads0, quads1), _mm_packs_epi32(quads2, quads3)));
+    }
+
+    pack_crumbs_scalar(samples + i, count - i, destination + i / 4);
+}
+
+void pack_nibbles_ssse3(const std::byte* samples, const size_t count, std::byte* destination) noexcept
+{
+    const __m128i pair_weights{_mm_set1_epi16(0x0110)};
+
+    size_t i{};
+    for (; i + 32 <= count; i += 32)
+    {
+        const auto* source{reinterpret_cast<const __m128i*>(samples + i)};
+        const __m128i pairs0{_mm_maddubs_epi16(_mm_loadu_si128(source), pair_weights)};
+        const __m128i pairs1{_mm_maddubs_epi16(_mm_loadu_si128(source + 1), pair_weights)};
+
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(destination + i / 2), _mm_packus_epi16(pairs0, pairs1));
+    }
+
+    pack_nibbles_scalar(samples + i, count - i, destination + i / 2);
+}
+
+void swap_rgb_ssse3(const std::byte* source, const size_t count, std::byte* destination) noexcept
+{
+    // 5 pixels per block: the 16th byte is stored unchanged and converted again as the first byte of the next block.
+    const __m128i swap_mask{_mm_setr_epi8(2, 1, 0, 5, 4, 3, 8, 7, 6, 11, 10, 9, 14, 13, 12, 15)};
+
+    size_t i{};
+    for (; i + 6 <= count; i += 5)
+    {
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(destination + i * 3),
+                         _mm_shuffle_epi8(_mm_loadu_si128(reinterpret_cast<const __m128i*>(source + i * 3)), swap_mask));
+    }
+
+    swap_rgb_scalar(source + i * 3, count - i, destination + i * 3);
+}
+
+void rgb_to_bgra_ssse3(const std::byte* source, const size_t count, std::byte* destination) noexcept
+{
+    // Expands 4 pixels of a 16 byte load, the zeroed alpha bytes (mask value -128) are set with an or.
+    const __m128i swap_mask{_mm_setr_epi8(2, 1, 0, -128, 5, 4, 3, -128, 8, 7, 6, -128, 11, 10, 9, -128)};
+    const __m128i alpha{_mm_set1_epi32(static_cast<int>(0xFF00'0000))};
+
+    size_t i{};
+    for (; i + 6 <= count; i += 4)
+    {
+        const __m128i pixels{_mm_loadu_si128(reinterpret_cast<const __m128i*>(source + i * 3))};
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(destination + i * 4),
+                         _mm_or_si128(_mm_shuffle_epi8(pixels, swap_mask), alpha));
+    }
+
+    rgb_to_bgra_scalar(source + i * 3, count - i, destination + i * 4);
+}
+
+void swap_rgba_ssse3(const std::byte* source, const size_t count, std::byte* destination) noexcept
+{
+    const __m128i swap_mask{_mm_setr_epi8(2, 1, 0, 3, 6, 5, 4, 7, 10, 9, 8, 11, 14, 13, 12, 15)};
+
+    size_t i{};
+    for (; i + 4 <= count; i += 4)
+    {
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(destination + i * 4),
+                         _mm_shuffle_epi8(_mm_loadu_si128(reinterpret_cast<const __m128i*>(source + i * 4)), swap_mask));
+    }
+
+    swap_rgba_scalar(source + i * 4, count - i, destination + i * 4);
+}
+
+// Multiplies the 16 bit colors of 2 pixels with their alpha (the alpha lanes are multiplied by 255) and divides by 255.
+[[nodiscard]] __m128i premultiply_sse2(const __m128i pixels, const __m128i alpha_lanes, const __m128i rounding) noexcept
+{
+    const __m128i alpha{_mm_or_si128(_mm_shufflehi_epi16(_mm_shufflelo_epi16(pixels, 0b11'11'11'11), 0b11'11'11'11),
+                                     alpha_lanes)};
+    const __m128i products{_mm_add_epi16(_mm_mullo_epi16(pixels, alpha), rounding)};
+    return _mm_srli_epi16(_mm_add_epi16(products, _mm_srli_epi16(products, 8)), 8);
+}
+
+void swap_and_premultiply_rgba_ssse3(const std::byte* source, const size_t count, std::byte* destination) noexcept
+{
+    const __m128i swap_mask{_mm_setr_epi8(2, 1, 0, 3, 6, 5, 4, 7, 10, 9, 8, 11, 14, 13, 12, 15)};
+    const __m128i alpha_lanes{_mm_setr_epi16(0, 0, 0, 255, 0, 0, 0, 255)};
+    const __m128i rounding{_mm_set1_epi16(128)};
+
+    size_t i{};
+    for (; i + 4 <= count; i += 4)
+    {
+        const __m128i pixels{
+            _mm_shuffle_epi8(_mm_loadu_si128(reinterpret_cast<const __m128i*>(source + i * 4)), swap_mask)};
+        const __m128i low{premultiply_sse2(_mm_unpacklo_epi8(pixels, _mm_setzero_si128()), alpha_lanes, rounding)};
+        const __m128i high{premultiply_sse2(_mm_unpackhi_epi8(pixels, _mm_setzero_si128()), alpha_lanes, rounding)};
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(destination + i * 4), _mm_packus_epi16(low, high));
+    }
+
+    swap_and_premultiply_rgba_scalar(source + i * 4, count - i, destination + i * 4);
+}
+
+void normalize_8_bit_sse2(const std::uint8_t* samples, const size_t count, const float scale,
+                          float* destination) noexcept
+{
+    const __m128 scales{_mm_set1_ps(scale)};
+    const __m128 ones{_mm_set1_ps(1.0F)};
+    const __m128i zero{_mm_setzero_si128()};
+
+    size_t i{};
+    for (; i + 16 <= count; i += 16)
+    {
+        const __m128i bytes{_mm_loadu_si128(reinterpret_cast<const __m128i*>(samples + i))};
+        const __m128i low{_mm_unpacklo_epi8(bytes, zero)};
+        const __m128i high{_mm_unpackhi_epi8(bytes, zero)};
+        const std::array words{_mm_unpacklo_epi16(low, zero), _mm_unpackhi_epi16(low, zero),
+                               _mm_unpacklo_epi16(high, zero), _mm_unpackhi_epi16(high, zero)};
+        for (size_t j{}; j != words.size(); ++j)
+        {
+            _mm_storeu_ps(destination + i + j * 4, _mm_min_ps(_mm_mul_ps(_mm_cvtepi32_ps(words[j]), scales), ones));
+        }
+    }
+
+    normalize_scalar(samples + i, count - i, scale, destination + i);
+}
+
+void normalize_16_bit_sse2(const uint16_t* samples, const size_t count, const float scale, float* destination) noexcept
+{
+    const __m128 scales{_mm_set1_ps(scale)};
+    const __m128 ones{_mm_set1_ps(1.0F)};
+    const __m128i zero{_mm_setzero_si128()};
+
+    size_t i{};
+    for (; i + 8 <= count; i += 8)
+    {
+        const __m128i words{_mm_loadu_si128(reinterpret_cast<const __m128i*>(samples + i))};
+        _mm_storeu_ps(destination + i,
+                      _mm_min_ps(_mm_mul_ps(_mm_cvtepi32_ps(_mm_unpacklo_epi16(words, zero)), scales), ones));
+        _mm_storeu_ps(destination + i + 4,
+                      _mm_min_ps(_mm_mul_ps(_mm_cvtepi32_ps(_mm_unpackhi_epi16(words, zero)), scales), ones));
+    }
+
+    normalize_scalar(samples + i, count - i, scale, destination + i);
+}
+
+// Expands 4 RGB pixels (3 vectors) to 4 RGBA pixels, the shuffles combine the samples of 2 vectors.
+void expand_rgb_sse2(const float* source, const size_t count, float* destination) noexcept
+{
+    const __m128 ones{_mm_set1_ps(1.0F)};
+
+    size_t i{};
+    for (; i + 4 <= count; i += 4)
+    {
+        const __m128 block0{_mm_loadu_ps(source + i * 3)};     // r0 g0 b0 r1
+        const __m128 block1{_mm_loadu_ps(source + i * 3 + 4)}; // g1 b1 r2 g2
+        const __m128 block2{_mm_loadu_ps(source + i * 3 + 8)}; // b2 r3 g3 b3
+
+        const __m128 blue0_alpha{_mm_shuffle_ps(block0, ones, _MM_SHUFFLE(0, 0, 2, 2))};
+        const __m128 red1{_mm_shuffle_ps(block0, block1, _MM_SHUFFLE(0, 0, 3, 3))};
+        const __m128 blue1_alpha{_mm_shuffle_ps(block1, ones, _MM_SHUFFLE(0, 0, 1, 1))};
+        const __m128 red2{_mm_shuffle_ps(block1, block2, _MM_SHUFFLE(0, 0, 3, 2))};
+        const __m128 blue2_alpha{_mm_shuffle_ps(red2, ones, _MM_SHUFFLE(0, 0, 2, 2))};
+        const __m128 blue3_alpha{_mm_shuffle_ps(block2, ones, _MM_SHUFFLE(0, 0, 3, 3))};
+
+        _mm_storeu_ps(destination + i * 4, _mm_shuffle_ps(block0, blue0_alpha, _MM_SHUFFLE(2, 0, 1, 0)));
+        _mm_storeu_ps(destination + i * 4 + 4, _mm_shuffle_ps(red1, blue1_alpha, _MM_SHUFFLE(2, 0, 2, 0)));
+        _mm_storeu_ps(destination + i * 4 + 8, _mm_shuffle_ps(red2, blue2_alpha, _MM_SHUFFLE(2, 0, 1, 0)));
+        _mm_storeu_ps(destination + i * 4 + 12, _mm_shuffle_ps(block2, blue3_alpha, _MM_SHUFFLE(2, 0, 2, 1)));
+    }
+
+    expand_rgb_scalar(source + i * 3, count - i, destination + i * 4);
+}
+
+void deinterleave_rgba_float_sse2(const std::byte* pixels, const size_t count, std::byte* const* planes) noexcept
+{
+    const auto* samples{reinterpret_cast<const float*>(pixels)};
+    const std::array plane_samples{reinterpret_cast<float*>(planes[0]), reinterpret_cast<float*>(planes[1]),
+                                   reinterpret_cast<float*>(planes[2]), reinterpret_cast<float*>(planes[3])};
+
+    size_t i{};
+    for (; i + 4 <= count; i += 4)
+    {
+        __m128 red{_mm_loadu_ps(samples + i * 4)};
+        __m128 green{_mm_loadu_ps(samples + i * 4 + 4)};
+        __m128 blue{_mm_loadu_ps(samples + i * 4 + 8)};
+        __m128 alpha{_mm_loadu_ps(samples + i * 4 + 12)};
+        _MM_TRANSPOSE4_PS(red, green, blue, alpha);
+        _mm_storeu_ps(plane_samples[0] + i, red);
+        _mm_storeu_ps(plane_samples[1] + i, green);
+        _mm_storeu_ps(plane_samples[2] + i, blue);
+        _mm_storeu_ps(plane_samples[3] + i, alpha);
+    }
+
+    deinterleave_samples<float>(pixels, i, count, 4, planes);
+}
+
+// pshufb masks that gather 1 channel of 16 RGB pixels from 3 registers (48 bytes), -128 clears a byte.
+alignas(16) constexpr std::array<std::array<std::int8_t, 16>, 9> rgb_plane_masks{{
+    {0, 3, 6, 9, 12, 15, -128, -128, -128, -128, -128, -128, -128, -128, -128, -128},
+    {-128, -128, -128, -128, -128, -128, 2, 5, 8, 11, 14, -128, -128, -128, -128, -128},
+    {-128, -128, -128, -128, -128, -128, -128, -128, -128, -128, -128, 1, 4, 7, 10, 13},
+    {1, 4, 7, 10, 13, -128, -128, -128, -128, -128, -128, -128, -128, -128, -128, -128},
+    {-128, -128, -128, -128, -128, 0, 3, 6, 9, 12, 15, -128, -128, -128, -128, -128},
+    {-128, -128, -128, -128, -128, -128, -128, -128, -128, -128, -128, 2, 5, 8, 11, 14},
+    {2, 5, 8, 11, 14, -128, -128, -128, -128, -128, -128, -128, -128, -128, -128, -128},
+    {-128, -128, -128, -128, -128, 1, 4, 7, 10, 13, -128, -128, -128, -128, -128, -128},
+    {-128, -128, -128, -128, -128, -128, -128, -128, -128, -128, 0, 3, 6, 9, 12, 15},
+}};
+
+void deinterleave_rgb_ssse3(const std::byte* pixels, const size_t count, std::byte* const* planes) noexcept
+{
+    const auto* masks{reinterpret_cast<const __m128i*>(rgb_plane_masks.data())};
+
+    size_t i{};
+    for (; i + 16 <= count; i += 16)
+    {
+        const auto* source{reinterpret_cast<const __m128i*>(pixels + i * 3)};
+        const __m128i block0{_mm_loadu_si128(source)};
+        const __m128i block1{_mm_loadu_si128(source + 1)};
+        const __m128i block2{_mm_loadu_si128(source + 2)};
+        for (size_t plane{}; plane != 3; ++plane)
+        {
+            const __m128i* plane_masks{masks + plane * 3};
+            const __m128i samples{_mm_or_si128(
+                _mm_or_si128(_mm_shuffle_epi8(block0, _mm_load_si128(plane_masks)),
+                             _mm_shuffle_epi8(block1, _mm_load_si128(plane_masks + 1))),
+                _mm_shuffle_epi8(block2, _mm_load_si128(plane_masks + 2)))};
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(planes[plane] + i), samples);
+        }
+    }
+
+    deinterleave_samples<std::uint8_t>(pixels, i, count, 3, planes);
+}
+
+void deinterleave_rgba_ssse3(const std::byte* pixels, const size_t count, std::byte* const* planes) noexcept
+{
+    // Gather the channels of every 4 pixels in 32 bit lanes and transpose the 4 x 4 lanes of 4 registers.
+    const __m128i gather_mask{_mm_setr_epi8(0, 4, 8, 12, 1, 5, 9, 13, 2, 6, 10, 14, 3, 7, 11, 15)};
+
+    size_t i{};
+    for (; i + 16 <= count; i += 16)
+    {
+        const auto* source{reinterpret_cast<const __m128i*>(pixels + i * 4)};
+        const __m128i block0{_mm_shuffle_epi8(_mm_loadu_si128(source), gather_mask)};
+        const __m128i block1{_mm_shuffle_epi8(_mm_loadu_si128(source + 1), gather_mask)};
+        const __m128i block2{_mm_shuffle_epi8(_mm_loadu_si128(source + 2), gather_mask)};
+        const __m128i block3{_mm_shuffle_epi8(_mm_loadu_si128(source + 3), gather_mask)};
+
+        const __m128i red_green01{_mm_unpacklo_epi32(block0, block1)};
+        const __m128i red_green23{_mm_unpacklo_epi32(block2, block3)};
+        const __m128i blue_alpha01{_mm_unpackhi_epi32(block0, block1)};
+        const __m128i blue_alpha23{_mm_unpackhi_epi32(block2, block3)};
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(planes[0] + i), _mm_unpacklo_epi64(red_green01, red_green23));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(planes[1] + i), _mm_unpackhi_epi64(red_green01, red_green23));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(planes[2] + i), _mm_unpacklo_epi64(blue_alpha01, blue_alpha23));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(planes[3] + i), _mm_unpackhi_epi64(blue_alpha01, blue_alpha23));
+    }
+
+    deinterleave_samples<std::uint8_t>(pixels, i, count, 4, planes);
+}
+
+void pack_crumbs_avx2(const std::byte* samples, const size_t count, std::byte* destination) noexcept
+{
+    const __m256i pair_weights{_mm256_set1_epi16(0x0104)};
+    const __m256i quad_weights{_mm256_set1_epi32(0x00010010)};
+
+    // The pack instructions work per 128 bit lane, this permutation restores the sample order.
+    const __m256i lane_order{_mm256_setr_epi32(0, 4, 1, 5, 2, 6, 3, 7)};
+
+    size_t i{};
+    for (; i + 128 <= count; i += 128)
+    {
+        const auto* source{reinterpret_cast<const __m256i*>(samples + i)};
+        const __m256i quads0{
+            _mm256_madd_epi16(_mm256_maddubs_epi16(_mm256_loadu_si256(source), pair_weights), quad_weights)};
+        const __m256i quads1{
+            _mm256_madd_epi16(_mm256_maddubs_epi16(_mm256_loadu_si256(source + 1), pair_weights), quad_weights)};
+        const __m256i quads2{
+            _mm256_madd_epi16(_mm256_maddubs_epi16(_mm256_loadu_si256(source + 2), pair_weights), quad_weights)};
+        const __m256i quads3{
+            _mm256_madd_epi16(_mm256_maddubs_epi16(_mm256_loadu_si256(source + 3), pair_weights), quad_weights)};
+
+        const __m256i packed{
+            _mm256_packus_epi16(_mm256_packs_epi32(quads0, quads1), _mm256_packs_epi32(quads2, quads3))};
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(destination + i / 4),
+                            _mm256_permutevar8x32_epi32(packed, lane_order));
+    }
+
+    _mm256_zeroupper();
+    pack_crumbs_scalar(samples + i, count - i, destination + i / 4);
+}
+
+void pack_nibbles_avx2(const std::byte* samples, const size_t count, std::byte* destination) noexcept
+{
+    const __m256i pair_weights{_mm256_set1_epi16(0x0110)};
+
+    size_t i{};
+    for (; i + 64 <= count; i += 64)
+    {
+        const auto* source{reinterpret_cast<const __m256i*>(samples + i)};
+        const __m256i pairs0{_mm256_maddubs_epi16(_mm256_loadu_si256(source), pair_weights)};
+        const __m256i pairs1{_mm256_maddubs_epi16(_mm256_loadu_si256(source + 1), pair_weights)};
+
+        // The pack instruction works per 128 bit lane, swap the middle quadwords to restore the sample order.
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(destination + i / 2),
+                            _mm256_permute4x64_epi64(_mm256_packus_epi16(pairs0, pairs1), 0b11'01'10'00));
+    }
+
+    _mm256_zeroupper();
+    pack_nibbles_scalar(samples + i, count - i, destination + i / 2);
+}
+
+// Divides 4 dwords by the divisor of the multiplier: the high dwords of the 64 bit products give the estimate.
+[[nodiscard]] __m128i divide_sse2(const __m128i dividends, const __m128i multiplier, const __m128i shift1,
+                                  const __m128i shift2) noexcept
+{
+    const __m128i even{_mm_srli_epi64(_mm_mul_epu32(dividends, multiplier), 32)};
+    const __m128i odd{_mm_and_si128(_mm_mul_epu32(_mm_srli_epi64(dividends, 32), multiplier),
+                                    _mm_set1_epi64x(static_cast<long long>(0xFFFF'FFFF'0000'0000)))};
+    const __m128i estimates{_mm_or_si128(even, odd)};
+    return _mm_srl_epi32(_mm_add_epi32(estimates, _mm_srl_epi32(_mm_sub_epi32(dividends, estimates), shift1)), shift2);
+}
+
+[[nodiscard]] __m128i scale_sse2(const __m128i samples, const __m128i rounding, const __m128i multiplier,
+                                 const __m128i shift1, const __m128i shift2) noexcept
+{
+    // sample * 65535 + max_value / 2 fits in 32 bits as sample <= max_value.
+    return divide_sse2(_mm_add_epi32(_mm_sub_epi32(_mm_slli_epi32(samples, 16), samples), rounding), multiplier,
+                       shift1, shift2);
+}
+
+void byte_swap_and_scale_sse2(uint16_t* samples, const size_t count, const uint16_t max_value) noexcept
+{
+    const scale_divisor divisor{create_scale_divisor(max_value)};
+    const __m128i max_values{_mm_set1_epi16(static_cast<short>(max_value))};
+    const __m128i rounding{_mm_set1_epi32(max_value / 2)};
+    const __m128i multiplier{_mm_set1_epi32(static_cast<int>(divisor.multiplier))};
+    const __m128i shift1{_mm_cvtsi32_si128(static_cast<int>(divisor.shift1))};
+    const __m128i shift2{_mm_cvtsi32_si128(static_cast<int>(divisor.shift2))};
+    const __m128i bias{_mm_set1_epi32(0x8000)};
+
+    size_t i{};
+    for (; i + 8 <= count; i += 8)
+    {
+        auto* block{reinterpret_cast<__m128i*>(samples + i)};
+        __m128i values{_mm_loadu_si128(block)};
+        values = _mm_or_si128(_mm_slli_epi16(values, 8), _mm_srli_epi16(values, 8));
+        values = _mm_sub_epi16(values, _mm_subs_epu16(values, max_values)); // unsigned minimum
+
+        const __m128i low{scale_sse2(_mm_unpacklo_epi16(values, _mm_setzero_si128()), rounding, multiplier, shift1,
+                                     shift2)};
+        const __m128i high{scale_sse2(_mm_unpackhi_epi16(values, _mm_setzero_si128()), rounding, multiplier, shift1,
+                                      shift2)};
+
+        // SSE2 can only pack with signed saturation: bias the values to the signed range and restore the sign bit.
+        _mm_storeu_si128(block, _mm_xor_si128(_mm_packs_epi32(_mm_sub_epi32(low, bias), _mm_sub_epi32(high, bias)),
+                                              _mm_set1_epi16(static_cast<short>(0x8000))));
+    }
+
+    byte_swap_and_scale_scalar(samples + i, count - i, max_value);
+}
+
+void byte_swap_and_narrow_sse2(const uint16_t* samples, const size_t count, const uint16_t max_value,
+                               std::uint8_t* destination) noexcept
+{
+    size_t i{};
+    if (max_value == 65535)
+    {
+        // Division by 257 without widening: (v - (v >> 8)) >> 8 with v = sample + 128 (saturated) is exact for all
+        // 16 bit samples.
+        const __m128i rounding{_mm_set1_epi16(128)};
+        for (; i + 16 <= count; i += 16)
+        {
+            __m128i values[2]{_mm_loadu_si128(reinterpret_cast<const __m128i*>(samples + i)),
+                              _mm_loadu_si128(reinterpret_cast<const __m128i*>(samples + i + 8))};
+            for (__m128i& value : values)
+            {
+                value = _mm_adds_epu16(_mm_or_si128(_mm_slli_epi16(value, 8), _mm_srli_epi16(value, 8)), rounding);
+                value = _mm_srli_epi16(_mm_sub_epi16(value, _mm_srli_epi16(value, 8)), 8);
+            }
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(destination + i), _mm_packus_epi16(values[0], values[1]));
+        }
+    }
+    else
+    {
+        const scale_divisor divisor{create_scale_divisor(max_value)};
+        const __m128i max_values{_mm_set1_epi16(static_cast<short>(max_value))};
+        const __m128i rounding{_mm_set1_epi32(max_value / 2)};
+        const __m128i multiplier{_mm_set1_epi32(static_cast<int>(divisor.multiplier))};
+        const __m128i shift1{_mm_cvtsi32_si128(static_cast<int>(divisor.shift1))};
+        const __m128i shift2{_mm_cvtsi32_si128(static_cast<int>(divisor.shift2))};
+        for (; i + 8 <= count; i += 8)
+        {
+            __m128i values{_mm_loadu_si128(reinterpret_cast<const __m128i*>(samples + i))};
+            values = _mm_or_si128(_mm_slli_epi16(values, 8), _mm_srli_epi16(values, 8));
+            values = _mm_sub_epi16(values, _mm_subs_epu16(values, max_values)); // unsigned minimum
+
+            // sample * 255 = (sample << 8) - sample, the rounded results fit in 8 bits.
+            const __m128i low{_mm_unpacklo_epi16(values, _mm_setzero_si128())};
+            const __m128i high{_mm_unpackhi_epi16(values, _mm_setzero_si128())};
+            const __m128i narrowed{_mm_packs_epi32(
+                divide_sse2(_mm_add_epi32(_mm_sub_epi32(_mm_slli_epi32(low, 8), low), rounding), multiplier, shift1,
+                            shift2),
+                divide_sse2(_mm_add_epi32(_mm_sub_epi32(_mm_slli_epi32(high, 8), high), rounding), multiplier, shift1,
+                            shift2))};
+            _mm_storel_epi64(reinterpret_cast<__m128i*>(destination + i), _mm_packus_epi16(narrowed, narrowed));
+        }
+    }
+
+    byte_swap_and_narrow_scalar(samples + i, count - i, max_value, destination + i);
+}
+
+void byte_swap_32_sse2(uint32_t* samples, const size_t count) noexcept
+{
+    size_t i{};
+    for (; i + 4 <= count; i += 4)
+    {
+        auto* block{reinterpret_cast<__m128i*>(samples + i)};
+        __m128i values{_mm_loadu_si128(block)};
+
+        // Swap the 16 bit halves of every dword, followed by the bytes of every word.
+        values = _mm_shufflehi_epi16(_mm_shufflelo_epi16(values, 0b10'11'00'01), 0b10'11'00'01);
+        _mm_storeu_si128(block, _mm_or_si128(_mm_slli_epi16(values, 8), _mm_srli_epi16(values, 8)));
+    }
+
+    for (; i != count; ++i)
+    {
+        samples[i] = std::byteswap(samples[i]);
+    }
+}
+
+void invert_bits_sse2(std::byte* bytes, const size_t count) noexcept
+{
+    const __m128i all_ones{_mm_set1_epi8(-1)};
+
+    size_t i{};
+    for (; i + 16 <= count; i += 16)
+    {
+        auto* block{reinterpret_cast<__m128i*>(bytes + i)};
+        _mm_storeu_si128(block, _mm_xor_si128(_mm_loadu_si128(block), all_ones));
+    }
+
+    for (; i != count; ++i)
+    {
+        bytes[i] = ~bytes[i];
+    }
+}
+
+// Returns the bit masks of the digits and the whitespace characters of a block of 16 characters.
+[[nodiscard]] std::pair<uint32_t, uint32_t> classify_ascii_block(const std::byte* text) noexcept
+{
+    const __m128i block{_mm_loadu_si128(reinterpret_cast<const __m128i*>(text))};
+
+    // SSE2 has no unsigned compare, min(x, limit) == x is used to test x <= limit.
+    const __m128i digit_values{_mm_sub_epi8(block, _mm_set1_epi8('0'))};
+    const __m128i digits{_mm_cmpeq_epi8(_mm_min_epu8(digit_values, _mm_set1_epi8(9)), digit_values)};
+    const __m128i control_values{_mm_sub_epi8(block, _mm_set1_epi8('\t'))};
+    const __m128i spaces{
+        _mm_or_si128(_mm_cmpeq_epi8(block, _mm_set1_epi8(' ')),
+                     _mm_cmpeq_epi8(_mm_min_epu8(control_values, _mm_set1_epi8('\r' - '\t')), control_values))};
+
+    return {static_cast<uint32_t>(_mm_movemask_epi8(digits)), static_cast<uint32_t>(_mm_movemask_epi8(spaces))};
+}
+
+#elif defined(_M_ARM64)
+
+void byte_swap_and_shift_neon(uint16_t* samples, const size_t count, const uint32_t sample_shift) noexcept
+{
+    const int16x8_t shift{vdupq_n_s16(static_cast<std::int16_t>(sample_shift))};
+
+    size_t i{};
+    for (; i + 8 <= count; i += 8)
+    {
+        const uint8x16_t bytes{vld1q_u8(reinterpret_cast<const std::uint8_t*>(samples + i))};
+        const uint16x8_t swapped{vreinterpretq_u16_u8(vrev16q_u8(bytes))};
+        vst1q_u16(samples + i, vshlq_u16(swapped, shift));
+    }
+
+    byte_swap_and_shift_scalar(samples + i, count - i, sample_shift);
+}
+
+void pack_crumbs_neon(const std::byte* samples, const size_t count, std::byte* destination) noexcept
+{
+    size_t i{};
+    for (; i + 64 <= count; i += 64)
+    {
+        // De-interleave 4 consecutive samples into 4 vectors and shift-insert them into 1 byte.
+        const uint8x16x4_t crumbs{vld4q_u8(reinterpret_cast<const std::uint8_t*>(samples + i))};
+        uint8x16_t packed{vsliq_n_u8(crumbs.val[3], crumbs.val[2], 2)};
+        packed = vsliq_n_u8(packed, crumbs.val[1], 4);
+        packed = vsliq_n_u8(packed, crumbs.val[0], 6);
+        vst1q_u8(reinterpret_cast<std::uint8_t*>(destination + i / 4), packed);
+    }
+
+    pack_crumbs_scalar(samples + i, count - i, destination + i / 4);
+}
+
+void pack_nibbles_neon(const std::byte* samples, const size_t count, std::byte* destination) noexcept
+{
+    size_t i{};
+    for (; i + 32 <= count; i += 32)
+    {
+        const uint8x16x2_t nibbles{vld2q_u8(reinterpret_cast<const std::uint8_t*>(samples + i))};
+        vst1q_u8(reinterpret_cast<std::uint8_t*>(destination + i / 2), vsliq_n_u8(nibbles.val[1], nibbles.val[0], 4));
+    }
+
+    pack_nibbles_scalar(samples + i, count - i, destination + i / 2);
+}
+
+void swap_rgb_neon(const std::byte* source, const size_t count, std::byte* destination) noexcept
+{
+    size_t i{};
+    for (; i + 16 <= count; i += 16)
+    {
+        uint8x16x3_t pixels{vld3q_u8(reinterpret_cast<const std::uint8_t*>(source + i * 3))};
+        std::swap(pixels.val[0], pixels.val[2]);
+        vst3q_u8(reinterpret_cast<std::uint8_t*>(destination + i * 3), pixels);
+    }
+
+    swap_rgb_scalar(source + i * 3, count - i, destination + i * 3);
+}
+
+void rgb_to_bgra_neon(const std::byte* source, const size_t count, std::byte* destination) noexcept
+{
+    size_t i{};
+    for (; i + 16 <= count; i += 16)
+    {
+        const uint8x16x3_t pixels{vld3q_u8(reinterpret_cast<const std::uint8_t*>(source + i * 3))};
+        vst4q_u8(reinterpret_cast<std::uint8_t*>(destination + i * 4),
+                 uint8x16x4_t{{pixels.val[2], pixels.val[1], pixels.val[0], vdupq_n_u8(0xFF)}});
+    }
+
+    rgb_to_bgra_scalar(source + i * 3, count - i, destination + i * 4);
+}
+
+void swap_rgba_neon(const std::byte* source, const size_t count, std::byte* destination) noexcept
+{
+    size_t i{};
+    for (; i + 16 <= count; i += 16)
+    {
+        uint8x16x4_t pixels{vld4q_u8(reinterpret_cast<const std::uint8_t*>(source + i * 4))};
+        std::swap(pixels.val[0], pixels.val[2]);
+        vst4q_u8(reinterpret_cast<std::uint8_t*>(destination + i * 4), pixels);
+    }
+
+    swap_rgba_scalar(source + i * 4, count - i, destination + i * 4);
+}
+
+// vraddhn(x, vrshr(x, 8)) computes (x + 128 + ((x + 128) >> 8)) >> 8, the same rounding as the scalar code.
+[[nodiscard]] uint8x16_t premultiply_neon(const uint8x16_t colors, const uint8x16_t alpha) noexcept
+{
+    const uint16x8_t low{vmull_u8(vget_low_u8(colors), vget_low_u8(alpha))};
+    const uint16x8_t high{vmull_high_u8(colors, alpha)};
+    return vcombine_u8(vraddhn_u16(low, vrshrq_n_u16(low, 8)), vraddhn_u16(high, vrshrq_n_u16(high, 8)));
+}
+
+void swap_and_premultiply_rgba_neon(const std::byte* source, const size_t count, std::byte* destination) noexcept
+{
+    size_t i{};
+    for (; i + 16 <= count; i += 16)
+    {
+        const uint8x16x4_t pixels{vld4q_u8(reinterpret_cast<const std::uint8_t*>(source + i * 4))};
+        vst4q_u8(reinterpret_cast<std::uint8_t*>(destination + i * 4),
+                 uint8x16x4_t{{premultiply_neon(pixels.val[2], pixels.val[3]),
+                               premultiply_neon(pixels.val[1], pixels.val[3]),
+                               premultiply_neon(pixels.val[0], pixels.val[3]), pixels.val[3]}});
+    }
+
+    swap_and_premultiply_rgba_scalar(source + i * 4, count - i, destination + i * 4);
+}
+
+void normalize_8_bit_neon(const std::uint8_t* samples, const size_t count, const float scale,
+                          float* destination) noexcept
+{
+    const float32x4_t ones{vdupq_n_f32(1.0F)};
+
+    size_t i{};
+    for (; i + 16 <= count; i += 16)
+    {
+        const uint8x16_t bytes{vld1q_u8(samples + i)};
+        const std::array words{vmovl_u8(vget_low_u8(bytes)), vmovl_high_u8(bytes)};
+        for (size_t j{}; j != words.size(); ++j)
+        {
+            vst1q_f32(destination + i + j * 8,
+                      vminq_f32(vmulq_n_f32(vcvtq_f32_u32(vmovl_u16(vget_low_u16(words[j]))), scale), ones));
+            vst1q_f32(destination + i + j * 8 + 4,
+                      vminq_f32(vmulq_n_f32(vcvtq_f32_u32(vmovl_high_u16(words[j])), scale), ones));
+        }
+    }
+
+    normalize_scalar(samples + i, count - i, scale, destination + i);
+}
+
+void normalize_16_bit_neon(const uint16_t* samples, const size_t count, const float scale, float* destination) noexcept
+{
+    const float32x4_t ones{vdupq_n_f32(1.0F)};
+
+    size_t i{};
+    for (; i + 8 <= count; i += 8)
+    {
+        const uint16x8_t words{vld1q_u16(samples + i)};
+        vst1q_f32(destination + i, vminq_f32(vmulq_n_f32(vcvtq_f32_u32(vmovl_u16(vget_low_u16(words))), scale), ones));
+        vst1q_f32(destination + i + 4, vminq_f32(vmulq_n_f32(vcvtq_f32_u32(vmovl_high_u16(words)), scale), ones));
+    }
+
+    normalize_scalar(samples + i, count - i, scale, destination + i);
+}
+
+void expand_rgb_neon(const float* source, const size_t count, float* destination) noexcept
+{
+    size_t i{};
+    for (; i + 4 <= count; i += 4)
+    {
+        const float32x4x3_t pixels{vld3q_f32(source + i * 3)};
+        vst4q_f32(destination + i * 4, float32x4x4_t{{pixels.val[0], pixels.val[1], pixels.val[2], vdupq_n_f32(1.0F)}});
+    }
+
+    expand_rgb_scalar(source + i * 3, count - i, destination + i * 4);
+}
+
+void deinterleave_rgba_float_neon(const std::byte* pixels, const size_t count, std::byte* const* planes) noexcept
+{
+    const auto* samples{reinterpret_cast<const float*>(pixels)};
+
+    size_t i{};
+    for (; i + 4 <= count; i += 4)
+    {
+        const float32x4x4_t channels{vld4q_f32(samples + i * 4)};
+        for (size_t plane{}; plane != 4; ++plane)
+        {
+            vst1q_f32(reinterpret_cast<float*>(planes[plane]) + i, channels.val[plane]);
+        }
+    }
+
+    deinterleave_samples<float>(pixels, i, count, 4, planes);
+}
+
+void deinterleave_rgb_neon(const std::byte* pixels, const size_t count, std::byte* const* planes) noexcept
+{
+    size_t i{};
+    for (; i + 16 <= count; i += 16)
+    {
+        const uint8x16x3_t channels{vld3q_u8(reinterpret_cast<const std::uint8_t*>(pixels + i * 3))};
+        for (size_t plane{}; plane != 3; ++plane)
+        {
+            vst1q_u8(reinterpret_cast<std::uint8_t*>(planes[plane] + i), channels.val[plane]);
+        }
+    }
+
+    deinterleave_samples<std::uint8_t>(pixels, i, count, 3, planes);
+}
+
+void deinterleave_rgba_neon(const std::byte* pixels, const size_t count, std::byte* const* planes) noexcept
+{
+    size_t i{};
+    for (; i + 16 <= count; i += 16)
+    {
+        const uint8x16x4_t channels{vld4q_u8(reinterpret_cast<const std::uint8_t*>(pixels + i * 4))};
+        for (size_t plane{}; plane != 4; ++plane)
+        {
+            vst1q_u8(reinterpret_cast<std::uint8_t*>(planes[plane] + i), channels.val[plane]);
+        }
+    }
+
+    deinterleave_samples<std::uint8_t>(pixels, i, count, 4, planes);
+}
+
+[[nodiscard]] uint32x4_t divide_neon(const uint32x4_t dividends, const uint32x2_t multiplier, const int32x4_t shift1,
+                                     const int32x4_t shift2) noexcept
+{
+    const uint32x4_t estimates{vcombine_u32(vshrn_n_u64(vmull_u32(vget_low_u32(dividends), multiplier), 32),
+                                            vshrn_n_u64(vmull_u32(vget_high_u32(dividends), multiplier), 32))};
+    return vshlq_u32(vaddq_u32(estimates, vshlq_u32(vsubq_u32(dividends, estimates), shift1)), shift2);
+}
+
+[[nodiscard]] uint32x4_t scale_neon(const uint16x4_t samples, const uint32x4_t rounding, const uint32x2_t multiplier,
+                                    const int32x4_t shift1, const int32x4_t shift2) noexcept
+{
+    const uint32x4_t widened{vmovl_u16(samples)};
+    return divide_neon(vaddq_u32(vsubq_u32(vshlq_n_u32(widened, 16), widened), rounding), multiplier, shift1, shift2);
+}
+
+void byte_swap_and_scale_neon(uint16_t* samples, const size_t count, const uint16_t max_value) noexcept
+{
+    const scale_divisor divisor{create_scale_divisor(max_value)};
+    const uint16x8_t max_values{vdupq_n_u16(max_value)};
+    const uint32x4_t rounding{vdupq_n_u32(max_value / 2U)};
+    const uint32x2_t multiplier{vdup_n_u32(divisor.multiplier)};
+    const int32x4_t shift1{vdupq_n_s32(-static_cast<int32_t>(divisor.shift1))};
+    const int32x4_t shift2{vdupq_n_s32(-static_cast<int32_t>(divisor.shift2))};
+
+    size_t i{};
+    for (; i + 8 <= count; i += 8)
+    {
+        const uint16x8_t values{vminq_u16(
+            vreinterpretq_u16_u8(vrev16q_u8(vld1q_u8(reinterpret_cast<const std::uint8_t*>(samples + i)))),
+            max_values)};
+        const uint32x4_t low{scale_neon(vget_low_u16(values), rounding, multiplier, shift1, shift2)};
+        const uint32x4_t high{scale_neon(vget_high_u16(values), rounding, multiplier, shift1, shift2)};
+        vst1q_u16(samples + i, vcombine_u16(vmovn_u32(low), vmovn_u32(high)));
+    }
+
+    byte_swap_and_scale_scalar(samples + i, count - i, max_value);
+}
+
+void byte_swap_and_narrow_neon(const uint16_t* samples, const size_t count, const uint16_t max_value,
+                               std::uint8_t* destination) noexcept
+{
+    size_t i{};
+    if (max_value == 65535)
+    {
+        // Division by 257 without widening, see byte_swap_and_narrow_sse2.
+        const uint16x8_t rounding{vdupq_n_u16(128)};
+        for (; i + 16 <= count; i += 16)
+        {
+            const auto* block{reinterpret_cast<const std::uint8_t*>(samples + i)};
+            const uint16x8_t low{vqaddq_u16(vreinterpretq_u16_u8(vrev16q_u8(vld1q_u8(block))), rounding)};
+            const uint16x8_t high{vqaddq_u16(vreinterpretq_u16_u8(vrev16q_u8(vld1q_u8(block + 16))), rounding)};
+            vst1q_u8(destination + i, vcombine_u8(vshrn_n_u16(vsubq_u16(low, vshrq_n_u16(low, 8)), 8),
+                                                  vshrn_n_u16(vsubq_u16(high, vshrq_n_u16(high, 8)), 8)));
+        }
+    }
+    else
+    {
+        const scale_divisor divisor{create_scale_divisor(max_value)};
+        const uint16x8_t max_values{vdupq_n_u16(max_value)};
+        const uint32x4_t rounding{vdupq_n_u32(max_value / 2U)};
+        const uint32x2_t multiplier{vdup_n_u32(divisor.multiplier)};
+        const int32x4_t shift1{vdupq_n_s32(-static_cast<int32_t>(divisor.shift1))};
+        const int32x4_t shift2{vdupq_n_s32(-static_cast<int32_t>(divisor.shift2))};
+        const uint16x4_t factor{vdup_n_u16(255)};
+        for (; i + 8 <= count; i += 8)
+        {
+            const uint16x8_t values{vminq_u16(
+                vreinterpretq_u16_u8(vrev16q_u8(vld1q_u8(reinterpret_cast<const std::uint8_t*>(samples + i)))),
+                max_values)};
+            const uint32x4_t low{divide_neon(vmlal_u16(rounding, vget_low_u16(values), factor), multiplier, shift1,
+                                             shift2)};
+            const uint32x4_t high{divide_neon(vmlal_u16(rounding, vget_high_u16(values), factor), multiplier, shift1,
+                                              shift2)};
+            vst1_u8(destination + i, vmovn_u16(vcombine_u16(vmovn_u32(low), vmovn_u32(high))));
+        }
+    }
+
+    byte_swap_and_narrow_scalar(samples + i, count - i, max_value, destination + i);
+}
+
+void byte_swap_32_neon(uint32_t* samples, const size_t count) noexcept
+{
+    size_t i{};
+    for (; i + 4 <= count; i += 4)
+    {
+        auto* block{reinterpret_cast<std::uint8_t*>(samples + i)};
+        vst1q_u8(block, vrev32q_u8(vld1q_u8(block)));
+    }
+
+    for (; i != count; ++i)
+    {
+        samples[i] = std::byteswap(samples[i]);
+    }
+}
+
+void invert_bits_neon(std::byte* bytes, const size_t count) noexcept
+{
+    size_t i{};
+    for (; i + 16 <= count; i += 16)
+    {
+        auto* block{reinterpret_cast<std::uint8_t*>(bytes + i)};
+        vst1q_u8(block, vmvnq_u8(vld1q_u8(block)));
+    }
+
+    for (; i != count; ++i)
+    {
+        bytes[i] = ~bytes[i];
+    }
+}
+
+[[nodiscard]] uint32_t to_bit_mask(const uint8x16_t mask) noexcept
+{
+    constexpr std::array<std::uint8_t, 16> bit_weights{1, 2, 4, 8, 16, 32, 64, 128, 1, 2, 4, 8, 16, 32, 64, 128};
+    const uint8x16_t bits{vandq_u8(mask, vld1q_u8(bit_weights.data()))};
+    return vaddv_u8(vget_low_u8(bits)) | static_cast<uint32_t>(vaddv_u8(vget_high_u8(bits))) << 8;
+}
+
+// Returns the bit masks of the digits and the whitespace characters of a block of 16 characters.
+[[nodiscard]] std::pair<uint32_t, uint32_t> classify_ascii_block(const std::byte* text) noexcept
+{
+    const uint8x16_t block{vld1q_u8(reinterpret_cast<const std::uint8_t*>(text))};
+    const uint8x16_t digits{vcleq_u8(vsubq_u8(block, vdupq_n_u8('0')), vdupq_n_u8(9))};
+    const uint8x16_t spaces{vorrq_u8(vceqq_u8(block, vdupq_n_u8(' ')),
+                                     vcleq_u8(vsubq_u8(block, vdupq_n_u8('\t')), vdupq_n_u8('\r' - '\t')))};
+
+    return {to_bit_mask(digits), to_bit_mask(spaces)};
+}
+
+#endif
+
+template<bool Vectorized>
+[[nodiscard]] ascii_parse_result parse_ascii_text(const span<const std::byte> text, const span<uint16_t> samples,
+                                                  const bool end_of_text) noexcept
+{
+    const std::byte* data{text.data()};
+    size_t position{};
+    size_t count{};
+
+#if defined(_M_IX86) || defined(_M_X64) || defined(_M_ARM64)
+    if constexpr (Vectorized)
+    {
+        // Classify 16 characters at once and locate the numbers with bit operations on the masks. Only numbers
+        // followed by whitespace inside the block are parsed, the block after the last whitespace is the next start.
+        constexpr size_t block_size{16};
+        while (count != samples.size() && position + block_size <= text.size())
+        {
+            const auto [digits, spaces]{classify_ascii_block(data + position)};
+            if ((digits | spaces) != 0xFFFF || spaces == 0)
+                break; // Invalid characters or a number that is too long, reported by the scalar loop.
+
+            const int last_space{31 - std::countl_zero(spaces)};
+            for (uint32_t starts{digits & ~(digits << 1) & ((2U << last_space) - 1)}; starts != 0; starts &= starts - 1)
+            {
+                const auto start{static_cast<size_t>(std::countr_zero(starts))};
+                const auto length{static_cast<size_t>(std::countr_zero(~(digits >> start)))};
+                if (!parse_sample(data + position + start, length, samples[count]))
+                    return {position + start, count, false};
+
+                if (++count == samples.size())
+                    return {position + start + length, count, true};
+            }
+
+            position += last_space + 1;
+        }
+    }
+#endif
+
+    while (count != samples.size())
+    {
+        while (position != text.size() && is_ascii_whitespace(data[position]))
+        {
+            ++position;
+        }
+        if (position == text.size())
+            break;
+
+        const size_t start{position};
+        while (position != text.size() && is_ascii_digit(data[position]))
+        {
+            ++position;
+        }
+
+        if (position == text.size() && !end_of_text)
+        {
+            // The number may continue in the next block of text.
+            if (count_significant_digits(data + start, position - start) > max_sample_digits)
+                return {start, count, false};
+
+            return {start, count, true};
+        }
+
+        if ((position != text.size() && !is_ascii_whitespace(data[position])) ||
+            !parse_sample(data + start, position - start, samples[count]))
+            return {start, count, false};
+
+        ++count;
+    }
+
+    return {position, count, true};
+}
+
+convert_to_little_endian_and_shift_function convert_to_little_endian_and_shift_kernel{byte_swap_and_shift_scalar};
+pack_function pack_to_crumbs_kernel{pack_crumbs_scalar};
+pack_function pack_to_nibbles_kernel{pack_nibbles_scalar};
+swizzle_function swap_rgb_kernel{swap_rgb_scalar};
+swizzle_function rgb_to_bgra_kernel{rgb_to_bgra_scalar};
+swizzle_function swap_rgba_kernel{swap_rgba_scalar};
+swizzle_function swap_and_premultiply_rgba_kernel{swap_and_premultiply_rgba_scalar};
+deinterleave_function deinterleave_rgb_kernel{deinterleave_rgb_scalar};
+deinterleave_function deinterleave_rgba_kernel{deinterleave_rgba_scalar};
+
+} // namespace
+
+
+void initialize_sample_conversion() noexcept
+{
+#if defined(_M_IX86) || defined(_M_X64)
+    if (const cpu_features features{detect_cpu_features()}; features.avx512bw)
+    {
+        convert_to_little_endian_and_shift_kernel = byte_swap_and_shift_avx512;
+    }
+    else if (features.avx2)
+    {
+        convert_to_little_endian_and_shift_kernel = byte_swap_and_shift_avx2;
+    }
+    else if (features.ssse3)
+    {
+        convert_to_little_endian_and_shift_kernel = byte_swap_and_shift_ssse3;
+    }
+
+    if (features.avx2)
+    {
+        pack_to_crumbs_kernel = pack_crumbs_avx2;
+        pack_to_nibbles_kernel = pack_nibbles_avx2;
+    }
+    else if (features.ssse3)
+    {
+        pack_to_crumbs_kernel = pack_crumbs_ssse3;
+        pack_to_nibbles_kernel = pack_nibbles_ssse3;
+    }
+
+    if (features.ssse3)
+    {
+        swap_rgb_kernel = swap_rgb_ssse3;
+        rgb_to_bgra_kernel = rgb_to_bgra_ssse3;
+        swap_rgba_kernel = swap_rgba_ssse3;
+        swap_and_premultiply_rgba_kernel = swap_and_premultiply_rgba_ssse3;
+        deinterleave_rgb_kernel = deinterleave_rgb_ssse3;
+        deinterleave_rgba_kernel = deinterleave_rgba_ssse3;
+    }
+#elif defined(_M_ARM64)
+    // NEON is a mandatory part of ARMv8, no runtime detection is needed.
+    convert_to_little_endian_and_shift_kernel = byte_swap_and_shift_neon;
+    pack_to_crumbs_kernel = pack_crumbs_neon;
+    pack_to_nibbles_kernel = pack_nibbles_neon;
+    swap_rgb_kernel = swap_rgb_neon;
+    rgb_to_bgra_kernel = rgb_to_bgra_neon;
+    swap_rgba_kernel = swap_rgba_neon;
+    swap_and_premultiply_rgba_kernel = swap_and_premultiply_rgba_neon;
+    deinterleave_rgb_kernel = deinterleave_rgb_neon;
+    deinterleave_rgba_kernel = deinterleave_rgba_neon;
+#endif
+}
+
+void convert_to_little_endian_and_shift(const span<uint16_t> samples, const uint32_t sample_shift) noexcept
+{
+    convert_to_little_endian_and_shift_kernel(samples.data(), samples.size(), sample_shift);
+}
+
+void convert_to_little_endian_and_shift_scalar(const span<uint16_t> samples, const uint32_t sample_shift) noexcept
+{
+    byte_swap_and_shift_scalar(samples.data(), samples.size(), sample_shift);
+}
+
+void convert_to_little_endian(const span<float> samples) noexcept
+{
+    auto* words{reinterpret_cast<uint32_t*>(samples.data())};
+
+#if defined(_M_IX86) || defined(_M_X64)
+    byte_swap_32_sse2(words, samples.size());
+#elif defined(_M_ARM64)
+    byte_swap_32_neon(words, samples.size());
+#else
+    for (size_t i{}; i != samples.size(); ++i)
+    {
+        words[i] = std::byteswap(words[i]);
+    }
+#endif
+}
+
+void convert_to_little_endian_and_scale(const span<uint16_t> samples, const uint16_t max_value) noexcept
+{
+#if defined(_M_IX86) || defined(_M_X64)
+    byte_swap_and_scale_sse2(samples.data(), samples.size(), max_value);
+#elif defined(_M_ARM64)
+    byte_swap_and_scale_neon(samples.data(), samples.size(), max_value);
+#else
+    byte_swap_and_scale_scalar(samples.data(), samples.size(), max_value);
+#endif
+}
+
+void convert_to_little_endian_and_scale_scalar(const span<uint16_t> samples, const uint16_t max_value) noexcept
+{
+    byte_swap_and_scale_scalar(samples.data(), samples.size(), max_value);
+}
+
+void narrow_to_8_bit(const span<const std::byte> samples, const uint16_t max_value, std::byte* destination) noexcept
+{
+    const auto* words{reinterpret_cast<const uint16_t*>(samples.data())};
+    auto* bytes{reinterpret_cast<std::uint8_t*>(destination)};
+#if defined(_M_IX86) || defined(_M_X64)
+    byte_swap_and_narrow_sse2(words, samples.size() / sizeof(uint16_t), max_value, bytes);
+#elif defined(_M_ARM64)
+    byte_swap_and_narrow_neon(words, samples.size() / sizeof(uint16_t), max_value, bytes);
+#else
+    byte_swap_and_narrow_scalar(words, samples.size() / sizeof(uint16_t), max_value, bytes);
+#endif
+}
+
+void narrow_to_8_bit_scalar(const span<const std::byte> samples, const uint16_t max_value,
+                            std::byte* destination) noexcept
+{
+    byte_swap_and_narrow_scalar(reinterpret_cast<const uint16_t*>(samples.data()), samples.size() / sizeof(uint16_t),
+                                max_value, reinterpret_cast<std::uint8_t*>(destination));
+}
+
+sample_converter::sample_converter(const uint32_t bits_per_sample, const uint32_t sample_shift,
+                                   const uint16_t max_value) noexcept :
+    bits_per_sample_{bits_per_sample},
+    sample_shift_{sample_shift},
+    max_value_{max_value},
+    scale_{(1U << bits_per_sample) - 1 != max_value}
+{
+    if (scale_ && bits_per_sample <= 8)
+    {
+        // A table lookup per sample is faster than any arithmetic for 8 bit samples.
+        for (uint32_t i{}; i != scale_table_.size(); ++i)
+        {
+            scale_table_[i] = static_cast<std::byte>(convert(static_cast<uint16_t>(i)));
+        }
+    }
+}
+
+void sample_converter::operator()(const span<std::byte> samples) const noexcept
+{
+    if (bits_per_sample_ > 8)
+    {
+        const span words{reinterpret_cast<uint16_t*>(samples.data()), samples.size() / sizeof(uint16_t)};
+        if (scale_)
+        {
+            convert_to_little_endian_and_scale(words, max_value_);
+        }
+        else
+        {
+            convert_to_little_endian_and_shift(words, sample_shift_);
+        }
+    }
+    else if (scale_)
+    {
+        for (std::byte& sample : samples)
+        {
+            sample = scale_table_[std::to_integer<size_t>(sample)];
+        }
+    }
+}
+
+uint16_t sample_converter::convert(const uint16_t sample) const noexcept
+{
+    const uint32_t clamped_sample{std::min(sample, max_value_)};
+    if (!scale_)
+        return static_cast<uint16_t>(clamped_sample << sample_shift_);
+
+    const uint32_t full_range{bits_per_sample_ > 8 ? 65535U : 255U};
+    return static_cast<uint16_t>((clamped_sample * full_range + max_value_ / 2U) / max_value_);
+}
+
+void pack_to_crumbs(const span<const std::byte> samples, std::byte* destination) noexcept
+{
+    pack_to_crumbs_kernel(samples.data(), samples.size(), destination);
+}
+
+void pack_to_nibbles(const span<const std::byte> samples, std::byte* destination) noexcept
+{
+    pack_to_nibbles_kernel(samples.data(), samples.size(), destination);
+}
+
+void pack_to_crumbs_scalar(const span<const std::byte> samples, std::byte* destination) noexcept
+{
+    pack_crumbs_scalar(samples.data(), samples.size(), destination);
+}
+
+void pack_to_nibbles_scalar(const span<const std::byte> samples, std::byte* destination) noexcept
+{
+    pack_nibbles_scalar(samples.data(), samples.size(), destination);
+}
+
+void convert_to_bgr(const bgr_conversion conversion, std::byte* pixels, const size_t count) noexcept
+{
+    switch (conversion)
+    {
+    case bgr_conversion::none:
+        break;
+
+    case bgr_conversion::rgb_to_bgr:
+        swap_rgb_kernel(pixels, count, pixels);
+        break;
+
+    case bgr_conversion::rgb_to_bgra:
+        rgb_to_bgra_kernel(pixels + count, count, pixels);
+        break;
+
+    case bgr_conversion::rgba_to_bgra:
+        swap_rgba_kernel(pixels, count, pixels);
+        break;
+
+    case bgr_conversion::rgba_to_premultiplied_bgra:
+        swap_and_premultiply_rgba_kernel(pixels, count, pixels);
+        break;
+    }
+}
+
+void convert_to_bgr_scalar(const bgr_conversion conversion, std::byte* pixels, const size_t count) noexcept
+{
+    switch (conversion)
+    {
+    case bgr_conversion::none:
+        break;
+
+    case bgr_conversion::rgb_to_bgr:
+        swap_rgb_scalar(pixels, count, pixels);
+        break;
+
+    case bgr_conversion::rgb_to_bgra:
+        rgb_to_bgra_scalar(pixels + count, count, pixels);
+        break;
+
+    case bgr_conversion::rgba_to_bgra:
+        swap_rgba_scalar(pixels, count, pixels);
+        break;
+
+    case bgr_conversion::rgba_to_premultiplied_bgra:
+        swap_and_premultiply_rgba_scalar(pixels, count, pixels);
+        break;
+    }
+}
+
+void convert_to_float(const span<const std::byte> samples, const uint32_t bits_per_sample, const float scale,
+                      float* destination) noexcept
+{
+    if (bits_per_sample == 8)
+    {
+        const auto* bytes{reinterpret_cast<const std::uint8_t*>(samples.data())};
+#if defined(_M_IX86) || defined(_M_X64)
+        normalize_8_bit_sse2(bytes, samples.size(), scale, destination);
+#elif defined(_M_ARM64)
+        normalize_8_bit_neon(bytes, samples.size(), scale, destination);
+#else
+        normalize_scalar(bytes, samples.size(), scale, destination);
+#endif
+    }
+    else
+    {
+        const auto* words{reinterpret_cast<const uint16_t*>(samples.data())};
+#if defined(_M_IX86) || defined(_M_X64)
+        normalize_16_bit_sse2(words, samples.size() / sizeof(uint16_t), scale, destination);
+#elif defined(_M_ARM64)
+        normalize_16_bit_neon(words, samples.size() / sizeof(uint16_t), scale, destination);
+#else
+        normalize_scalar(words, samples.size() / sizeof(uint16_t), scale, destination);
+#endif
+    }
+}
+
+void convert_to_float_scalar(const span<const std::byte> samples, const uint32_t bits_per_sample, const float scale,
+                             float* destination) noexcept
+{
+    if (bits_per_sample == 8)
+    {
+        normalize_scalar(reinterpret_cast<const std::uint8_t*>(samples.data()), samples.size(), scale, destination);
+    }
+    else
+    {
+        normalize_scalar(reinterpret_cast<const uint16_t*>(samples.data()), samples.size() / sizeof(uint16_t), scale,
+                         destination);
+    }
+}
+
+void expand_rgb_to_rgba(float* pixels, const size_t count) noexcept
+{
+#if defined(_M_IX86) || defined(_M_X64)
+    expand_rgb_sse2(pixels + count, count, pixels);
+#elif defined(_M_ARM64)
+    expand_rgb_neon(pixels + count, count, pixels);
+#else
+    expand_rgb_scalar(pixels + count, count, pixels);
+#endif
+}
+
+void expand_rgb_to_rgba_scalar(float* pixels, const size_t count) noexcept
+{
+    expand_rgb_scalar(pixels + count, count, pixels);
+}
+
+void deinterleave(const std::byte* pixels, const size_t count, const size_t samples_per_pixel, const size_t sample_size,
+                  std::byte* const* planes) noexcept
+{
+    switch (sample_size)
+    {
+    case 1:
+        if (samples_per_pixel == 3)
+        {
+            deinterleave_rgb_kernel(pixels, count, planes);
+        }
+        else if (samples_per_pixel == 4)
+        {
+            deinterleave_rgba_kernel(pixels, count, planes);
+        }
+        else
+        {
+            deinterleave_samples<std::uint8_t>(pixels, 0, count, samples_per_pixel, planes);
+        }
+        break;
+
+    case 2:
+        deinterleave_samples<uint16_t>(pixels, 0, count, samples_per_pixel, planes);
+        break;
+
+    default:
+#if defined(_M_IX86) || defined(_M_X64)
+        if (samples_per_pixel == 4)
+        {
+            deinterleave_rgba_float_sse2(pixels, count, planes);
+            break;
+        }
+#elif defined(_M_ARM64)
+        if (samples_per_pixel == 4)
+        {
+            deinterleave_rgba_float_neon(pixels, count, planes);
+            break;
+        }
+#endif
+        deinterleave_samples<float>(pixels, 0, count, samples_per_pixel, planes);
+        break;
+    }
+}
+
+void deinterleave_scalar(const std::byte* pixels, const size_t count, const size_t samples_per_pixel,
+                         const size_t sample_size, std::byte* const* planes) noexcept
+{
+    switch (sample_size)
+    {
+    case 1:
+        deinterleave_samples<std::uint8_t>(pixels, 0, count, samples_per_pixel, planes);
+        break;
+
+    case 2:
+        deinterleave_samples<uint16_t>(pixels, 0, count, samples_per_pixel, planes);
+        break;
+
+    default:
+        deinterleave_samples<float>(pixels, 0, count, samples_per_pixel, planes);
+        break;
+    }
+}
+
+ascii_parse_result parse_ascii_samples(const span<const std::byte> text, const span<uint16_t> samples,
+                                       const bool end_of_text) noexcept
+{
+    return parse_ascii_text<true>(text, samples, end_of_text);
+}
+
+ascii_parse_result parse_ascii_samples_scalar(const span<const std::byte> text, const span<uint16_t> samples,
+                                              const bool end_of_text) noexcept
+{
+    return parse_ascii_text<false>(text, samples, end_of_text);
+}
+
+void invert_bits(const span<std::byte> bytes) noexcept
+{
+#if defined(_M_IX86) || defined(_M_X64)
+    invert_bits_sse2(bytes.data(), bytes.size());
+#elif defined(_M_ARM64)
+    invert_bits_neon(bytes.data(), bytes.size());
+#else
+    for (std::byte& value : bytes)
+    {
+        value = ~value;
+    }
+#endif
+}
+
+ascii_parse_result parse_ascii_bits(const span<const std::byte> text, const span<std::byte> samples) noexcept
+{
+    size_t position{};
+    size_t count{};
+    for (; position != text.size() && count != samples.size(); ++position)
+    {
+        if (const std::byte c{text[position]}; c == std::byte{'0'} || c == std::byte{'1'})
+        {
+            samples[count++] = c & std::byte{1};
+        }
+        else if (!is_ascii_whitespace(c))
+        {
+            return {position, count, false};
+        }
+    }
+
+    return {position, count, true};
+}
@@ -0,0 +1,125 @@
+// SPDX-FileCopyrightText: © 2026 Team CharLS
+// SPDX-License-Identifier: BSD-3-Clause
+
+export module sample_conversion;
+
+import std;
+
+export {
+
+/// <summary>
+/// Selects the fastest conversion kernels supported by the CPU. Called once when the DLL is loaded.
+/// </summary>
+void initialize_sample_conversion() noexcept;
+
+// Binary 16 bit Netpbm images are stored in big endian format (the de facto standard).
+void convert_to_little_endian_and_shift(std::span<std::uint16_t> samples, std::uint32_t sample_shift) noexcept;
+
+inline void convert_to_little_endian(const std::span<std::uint16_t> samples) noexcept
+{
+    convert_to_little_endian_and_shift(samples, 0);
+}
+
+// Big endian Portable Float Map (PFM) images store the samples as big endian 32 bit floats.
+void convert_to_little_endian(std::span<float> samples) noexcept;
+
+// Converts and rescales samples with a maximum value that doesn't fill 16 bits to the full 16 bit range.
+// Samples larger than max_value are clamped.
+void convert_to_little_endian_and_scale(std::span<std::uint16_t> samples, std::uint16_t max_value) noexcept;
+
+// Rounds big endian 16 bit samples to 8 bit samples: (sample * 255 + max_value / 2) / max_value. Samples larger than
+// max_value are clamped. Used to decode 16 bit images directly to 8 bit pixel formats.
+void narrow_to_8_bit(std::span<const std::byte> samples, std::uint16_t max_value, std::byte* destination) noexcept;
+
+// Converts the stored 8 or 16 bit samples of an image in place to the samples of its WIC pixel format.
+// Samples with a maximum value that doesn't fill all bits of the WIC samples are rescaled to the full range.
+class sample_converter final
+{
+public:
+    sample_converter() = default;
+    sample_converter(std::uint32_t bits_per_sample, std::uint32_t sample_shift, std::uint16_t max_value) noexcept;
+
+    // 8 bit samples that don't need to be rescaled are stored as is.
+    [[nodiscard]] bool is_identity() const noexcept
+    {
+        return bits_per_sample_ <= 8 && !scale_;
+    }
+
+    // Converts binary samples, 16 bit samples are stored in big endian format.
+    void operator()(std::span<std::byte> samples) const noexcept;
+
+    // Converts a single ASCII sample.
+    [[nodiscard]] std::uint16_t convert(std::uint16_t sample) const noexcept;
+
+private:
+    std::uint32_t bits_per_sample_{};
+    std::uint32_t sample_shift_{};
+    std::uint16_t max_value_{};
+    bool scale_{};
+    std::array<std::byte, 256> scale_table_{};
+};
+
+// Packs 1 row of 2 bit samples (stored 1 sample per byte) into 4 pixels per byte, first pixel in the high bits.
+void pack_to_crumbs(std::span<const std::byte> samples, std::byte* destination) noexcept;
+
+// Packs 1 row of 4 bit samples (stored 1 sample per byte) into 2 pixels per byte, first pixel in the high bits.
+void pack_to_nibbles(std::span<const std::byte> samples, std::byte* destination) noexcept;
+
+// Conversions of 8 bit RGB(A) pixels to the BGR(A) pixel formats used by Direct2D, WPF and GDI.
+enum class bgr_conversion
+{
+    none,
+    rgb_to_bgr,
+    rgb_to_bgra,
+    rgba_to_bgra,
+    rgba_to_premultiplied_bgra
+};
+
+// Converts 1 row of count pixels in place. For rgb_to_bgra the RGB pixels are expected at pixels + count: the
+// 4 byte pixels grow from the start of the row over the 3 byte pixels, which are read before they are overwritten.
+void convert_to_bgr(bgr_conversion conversion, std::byte* pixels, size_t count) noexcept;
+
+// Normalizes 8 or 16 bit samples (in the byte order of the platform) to floats: sample * scale, clamped to 1.
+void convert_to_float(std::span<const std::byte> samples, std::uint32_t bits_per_sample, float scale,
+                      float* destination) noexcept;
+
+// Expands 1 row of count RGB float pixels stored at pixels + count in place to RGBA pixels with an alpha of 1.
+void expand_rgb_to_rgba(float* pixels, size_t count) noexcept;
+
+// Splits count interleaved pixels into 1 plane per sample. Samples are 1, 2 or 4 (float) bytes.
+void deinterleave(const std::byte* pixels, size_t count, size_t samples_per_pixel, size_t sample_size,
+                  std::byte* const* planes) noexcept;
+
+struct ascii_parse_result final
+{
+    size_t consumed; // A number at the end of the text is not consumed when it may continue in the next block.
+    size_t sample_count;
+    bool valid;
+};
+
+// Parses whitespace separated decimal samples of the ASCII Netpbm formats (P1, P2, P3) until samples is full.
+ascii_parse_result parse_ascii_samples(std::span<const std::byte> text, std::span<std::uint16_t> samples,
+                                       bool end_of_text) noexcept;
+
+// Parses the samples of the ASCII bitmap format (P1): 1 character per sample, whitespace between samples is optional.
+ascii_parse_result parse_ascii_bits(std::span<const std::byte> text, std::span<std::byte> samples) noexcept;
+
+// Netpbm bitmaps use 1 for black, WIC BlackWhite uses 1 for white.
+void invert_bits(std::span<std::byte> bytes) noexcept;
+
+// Reference implementations, used to verify the vectorized kernels.
+void convert_to_little_endian_and_shift_scalar(std::span<std::uint16_t> samples, std::uint32_t sample_shift) noexcept;
+void convert_to_little_endian_and_scale_scalar(std::span<std::uint16_t> samples, std::uint16_t max_value) noexcept;
+void narrow_to_8_bit_scalar(std::span<const std::byte> samples, std::uint16_t max_value, std::byte* destination) noexcept;
+void pack_to_crumbs_scalar(std::span<const std::byte> samples, std::byte* destination) noexcept;
+void pack_to_nibbles_scalar(std::span<const std::byte> samples, std::byte* destination) noexcept;
+void convert_to_bgr_scalar(bgr_conversion conversion, std::byte* pixels, size_t count) noexcept;
+void convert_to_float_scalar(std::span<const std::byte> samples, std::uint32_t bits_per_sample, float scale,
+                             float* destination) noexcept;
+void expand_rgb_to_rgba_scalar(float* pixels, size_t count) noexcept;
+void deinterleave_scalar(const std::byte* pixels, size_t count, size_t samples_per_pixel, size_t sample_size,
+                         std::byte* const* planes) noexcept;
+ascii_parse_result parse_ascii_samples_scalar(std::span<const std::byte> text, std::span<std::uint16_t> samples,
+                                              bool end_of_text) noexcept;
+
+}
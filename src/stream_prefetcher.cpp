@@ -0,0 +1,148 @@
+// SPDX-FileCopyrightText: © 2026 Team CharLS
+// SPDX-License-Identifier: BSD-3-Clause
+
+module;
+
+#include "intellisense.hpp"
+
+module stream_prefetcher;
+
+import <win.hpp>;
+import std;
+import winrt_base;
+
+import hresults;
+import util;
+
+namespace {
+
+// Large enough to amortize the latency of a read call, small enough to start converting soon.
+constexpr size_t chunk_size{1024 * 1024};
+
+// 1 chunk is processed by the calling thread while the other one is read.
+constexpr size_t chunk_count{2};
+
+} // namespace
+
+
+stream_prefetcher::stream_prefetcher(_In_ IStream* stream, const std::uint64_t size) : remaining_size_{size}
+{
+    stream_.copy_from(stream);
+
+    const size_t buffer_size{static_cast<size_t>(std::min(size, std::uint64_t{chunk_size}))};
+    for (size_t i{}; i != chunk_count; ++i)
+    {
+        free_chunks_.emplace_back(buffer_size);
+    }
+
+    thread_ = std::jthread{[this] { run(); }};
+}
+
+stream_prefetcher::~stream_prefetcher()
+{
+    stop();
+}
+
+size_t stream_prefetcher::read(std::byte* destination, const size_t size)
+{
+    return consume(destination, size);
+}
+
+size_t stream_prefetcher::skip(const size_t size)
+{
+    return consume(nullptr, size);
+}
+
+size_t stream_prefetcher::consume(std::byte* destination, const size_t size)
+{
+    size_t consumed{};
+    while (consumed != size)
+    {
+        if (current_position_ == current_chunk_.size)
+        {
+            std::unique_lock lock{mutex_};
+            if (!current_chunk_.data.empty())
+            {
+                free_chunks_.push_back(std::move(current_chunk_.data));
+                chunk_released_.notify_one();
+            }
+
+            chunk_read_.wait(lock, [this] { return !read_chunks_.empty() || read_completed_; });
+            if (read_chunks_.empty())
+            {
+                check_hresult(read_result_, wincodec::error_stream_read);
+                current_chunk_ = {};
+                current_position_ = 0;
+                break;
+            }
+
+            current_chunk_ = std::move(read_chunks_.front());
+            read_chunks_.pop_front();
+            current_position_ = 0;
+        }
+
+        const size_t count{std::min(size - consumed, current_chunk_.size - current_position_)};
+        if (destination)
+        {
+            std::memcpy(destination + consumed, current_chunk_.data.data() + current_position_, count);
+        }
+        current_position_ += count;
+        consumed += count;
+    }
+
+    return consumed;
+}
+
+void stream_prefetcher::stop() noexcept
+{
+    // A pending IStream::Read can't be cancelled: the thread exits after it returns.
+    {
+        std::scoped_lock lock{mutex_};
+        stopping_ = true;
+    }
+    chunk_released_.notify_all();
+    if (thread_.joinable())
+    {
+        thread_.join();
+    }
+}
+
+void stream_prefetcher::run()
+{
+    const multithreaded_apartment apartment;
+    for (;;)
+    {
+        std::vector<std::byte> data;
+        {
+            std::unique_lock lock{mutex_};
+            chunk_released_.wait(lock, [this] { return stopping_ || !free_chunks_.empty(); });
+            if (stopping_)
+                return;
+
+            data = std::move(free_chunks_.back());
+            free_chunks_.pop_back();
+        }
+
+        const auto read_size{static_cast<ULONG>(std::min(remaining_size_, std::uint64_t{data.size()}))};
+        ULONG bytes_read{};
+        const HRESULT result{stream_->Read(data.data(), read_size, &bytes_read)};
+        remaining_size_ -= bytes_read;
+
+        {
+            std::scoped_lock lock{mutex_};
+            if (bytes_read != 0 && !failed(result))
+            {
+                read_chunks_.push_back({std::move(data), bytes_read});
+            }
+
+            // Streams may return less than requested before the end: only an empty read is the end of the stream.
+            // A stream that ends before all data is read is truncated, the data can't be handed out as complete.
+            read_completed_ = failed(result) || bytes_read == 0 || remaining_size_ == 0;
+            read_result_ = !failed(result) && bytes_read == 0 && remaining_size_ != 0 ? wincodec::error_stream_read : result;
+        }
+        chunk_read_.notify_one();
+
+        if (read_completed_)
+            return;
+    }
+}
@@ -0,0 +1,62 @@
+// SPDX-FileCopyrightText: © 2026 Team CharLS
+// SPDX-License-Identifier: BSD-3-Clause
+
+module;
+
+#include "intellisense.hpp"
+
+export module stream_prefetcher;
+
+import <win.hpp>;
+import std;
+import winrt_base;
+
+// Reads a stream sequentially on a background thread while the calling thread processes the data that is already
+// read: the I/O latency of slow streams (for example a file on a network share) overlaps with the decoding.
+// The data is read in 2 chunks (double buffering), which bounds the memory that is used.
+export class stream_prefetcher final
+{
+public:
+    // Prefetches size bytes, starting at the current position of the stream. The stream must be free threaded (it is
+    // read from a thread in the multithreaded apartment) and may not be used by others until the prefetcher is destroyed.
+    // A stream that ends before size bytes are read is reported as a read error.
+    stream_prefetcher(_In_ IStream* stream, std::uint64_t size);
+    ~stream_prefetcher();
+
+    stream_prefetcher(const stream_prefetcher&) = delete;
+    stream_prefetcher(stream_prefetcher&&) = delete;
+    stream_prefetcher& operator=(const stream_prefetcher&) = delete;
+    stream_prefetcher& operator=(stream_prefetcher&&) = delete;
+
+    // Copies the next bytes, waits until they are read. Returns less than size at the end of the prefetched data.
+    // A failed read of the background thread is thrown as WINCODEC_ERR_STREAMREAD.
+    [[nodiscard]] size_t read(std::byte* destination, size_t size);
+
+    // Discards the next bytes, returns less than size at the end of the prefetched data.
+    [[nodiscard]] size_t skip(size_t size);
+
+private:
+    struct chunk final
+    {
+        std::vector<std::byte> data;
+        size_t size{};
+    };
+
+    size_t consume(std::byte* destination, size_t size);
+    void stop() noexcept;
+    void run();
+
+    winrt::com_ptr<IStream> stream_;
+    std::uint64_t remaining_size_;
+    std::mutex mutex_;
+    std::condition_variable chunk_read_;
+    std::condition_variable chunk_released_;
+    std::vector<std::vector<std::byte>> free_chunks_;
+    std::deque<chunk> read_chunks_;
+    HRESULT read_result_{};
+    bool read_completed_{};
+    bool stopping_{};
+    chunk current_chunk_;
+    size_t current_position_{};
+    std::jthread thread_;
+};
@@ -97,6 +97,67 @@ T* check_out_pointer(T* pointer)
     return pointer;
 }
 
+// True when the object may be called from any thread: it is agile or aggregates the free threaded marshaler.
+// Other objects (for example a stream of a single threaded apartment) may only be called from their own apartment.
+export [[nodiscard]] bool is_free_threaded(_In_ IUnknown* object) noexcept
+{
+    if (winrt::com_ptr<IAgileObject> agile_object; !failed(object->QueryInterface(IID_PPV_ARGS(agile_object.put()))))
+        return true;
+
+    winrt::com_ptr<IMarshal> marshal;
+    CLSID unmarshal_class;
+    return !failed(object->QueryInterface(IID_PPV_ARGS(marshal.put()))) &&
+           !failed(marshal->GetUnmarshalClass(IID_IUnknown, object, MSHCTX_INPROC, nullptr, MSHLFLAGS_NORMAL,
+                                              &unmarshal_class)) &&
+           unmarshal_class == CLSID_InProcFreeMarshaler;
+}
+
+// Joins the multithreaded apartment for the lifetime of the object: threads started by the codec that call COM objects
+// must be in an apartment.
+export class multithreaded_apartment final
+{
+public:
+    multithreaded_apartment() noexcept : initialized_{!failed(CoInitializeEx(nullptr, COINIT_MULTITHREADED))}
+    {
+    }
+
+    ~multithreaded_apartment()
+    {
+        if (initialized_)
+        {
+            CoUninitialize();
+        }
+    }
+
+    multithreaded_apartment(const multithreaded_apartment&) = delete;
+    multithreaded_apartment(multithreaded_apartment&&) = delete;
+    multithreaded_apartment& operator=(const multithreaded_apartment&) = delete;
+    multithreaded_apartment& operator=(multithreaded_apartment&&) = delete;
+
+private:
+    bool initialized_;
+};
+
+// Creates the WIC imaging factory on first use and keeps it. The factory is free threaded: a decoder shares it with its
+// frames. Concurrent callers wait until it is created, a failed attempt is retried by the next call.
+export class imaging_factory_cache final
+{
+public:
+    [[nodiscard]] IWICImagingFactory* get()
+    {
+        std::call_once(created_, [this] {
+            winrt::check_hresult(CoCreateInstance(CLSID_WICImagingFactory, nullptr, CLSCTX_INPROC_SERVER,
+                                                  IID_PPV_ARGS(factory_.put())));
+        });
+
+        return factory_.get();
+    }
+
+private:
+    std::once_flag created_;
+    winrt::com_ptr<IWICImagingFactory> factory_;
+};
+
 export void check_condition(const bool condition, const hresult result_to_throw)
 {
     if (!condition)
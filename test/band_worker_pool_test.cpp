@@ -0,0 +1,45 @@
+// SPDX-FileCopyrightText: © 2026 Team CharLS
+// SPDX-License-Identifier: BSD-3-Clause
+
+#include "cpp_unit_test.hpp"
+
+import std;
+
+import band_worker_pool;
+
+using namespace Microsoft::VisualStudio::CppUnitTestFramework;
+
+TEST_CLASS(band_worker_pool_test)
+{
+public:
+    TEST_METHOD(wait_completes_all_work) // NOLINT
+    {
+        std::vector<int> bands(1000);
+        band_worker_pool worker_pool{4};
+
+        for (size_t i{}; i != bands.size(); ++i)
+        {
+            worker_pool.submit([&bands, i] { bands[i] = static_cast<int>(i) + 1; });
+        }
+        worker_pool.wait();
+
+        for (size_t i{}; i != bands.size(); ++i)
+        {
+            Assert::AreEqual(static_cast<int>(i) + 1, bands[i]);
+        }
+    }
+
+    TEST_METHOD(destructor_completes_queued_work) // NOLINT
+    {
+        std::atomic<int> count{};
+        {
+            band_worker_pool worker_pool{2};
+            for (int i{}; i != 100; ++i)
+            {
+                worker_pool.submit([&count] { ++count; });
+            }
+        }
+
+        Assert::AreEqual(100, count.load());
+    }
+};
@@ -29,6 +29,7 @@ TEST_CLASS(buffered_stream_reader_test)
         reader.read_bytes(destination.data(), static_cast<ULONG>(destination.size()), &bytes_read);
 
         Assert::AreEqual(2UL, bytes_read);
+        Assert::IsFalse(reader.is_memory_backed());
     }
 
     TEST_METHOD(read_bytes_not_enough_available) // NOLINT
@@ -44,6 +45,23 @@ TEST_CLASS(buffered_stream_reader_test)
         Assert::AreEqual(1UL, bytes_read);
     }
 
+    TEST_METHOD(read_bytes_beyond_end_of_stream_throws) // NOLINT
+    {
+        std::vector<char> source(10000);
+        buffered_stream_reader reader(create_memory_stream(source).get());
+
+        std::vector<std::byte> destination(10001);
+        try
+        {
+            reader.read_bytes(destination.data(), destination.size());
+            Assert::Fail();
+        }
+        catch (const winrt::hresult_error& error)
+        {
+            Assert::AreEqual(WINCODEC_ERR_STREAMREAD, static_cast<HRESULT>(error.code()));
+        }
+    }
+
     TEST_METHOD(read_int) // NOLINT
     {
         std::vector<char> source;
@@ -56,6 +74,139 @@ TEST_CLASS(buffered_stream_reader_test)
         Assert::AreEqual(256U, value);
     }
 
+    TEST_METHOD(skip_within_buffer) // NOLINT
+    {
+        std::vector<char> source{0, 1, 2, 3};
+        buffered_stream_reader reader(create_memory_stream(source).get());
+
+        reader.skip(2);
+        std::byte value;
+        reader.read_bytes(&value, 1);
+
+        Assert::AreEqual(2, static_cast<int>(value));
+        Assert::AreEqual(3ULL, reader.position());
+    }
+
+    TEST_METHOD(skip_beyond_buffer) // NOLINT
+    {
+        std::vector<char> source(100000);
+        source[70000] = 7;
+        buffered_stream_reader reader(create_memory_stream(source).get());
+
+        reader.skip(70000);
+        std::byte value;
+        reader.read_bytes(&value, 1);
+
+        Assert::AreEqual(7, static_cast<int>(value));
+        Assert::AreEqual(70001ULL, reader.position());
+    }
+
+    TEST_METHOD(read_bytes_with_row_gap) // NOLINT
+    {
+        const std::array source{std::byte{1}, std::byte{2}, std::byte{3}, std::byte{4}, std::byte{5},
+                                std::byte{6}, std::byte{7}, std::byte{8}};
+        buffered_stream_reader reader(span<const std::byte>{source}.subspan(1));
+        reader.set_row_gap(2, 1);
+
+        std::array<std::byte, 5> destination{};
+        reader.read_bytes(destination.data(), 1);
+        reader.read_bytes(destination.data() + 1, destination.size() - 1);
+
+        Assert::IsTrue(std::ranges::equal(
+            destination, std::array{std::byte{2}, std::byte{3}, std::byte{5}, std::byte{6}, std::byte{8}}));
+        Assert::AreEqual(7ULL, reader.position());
+    }
+
+    TEST_METHOD(read_ahead) // NOLINT
+    {
+        std::vector<char> source(3 * 1024 * 1024);
+        for (size_t i{}; i != source.size(); ++i)
+        {
+            source[i] = static_cast<char>(i % 253);
+        }
+        buffered_stream_reader reader(create_memory_stream(source).get());
+        reader.start_read_ahead(source.size());
+
+        std::vector<char> destination(1024 * 1024);
+        reader.read_bytes(destination.data(), 100);
+        reader.skip(1024 * 1024);
+        reader.read_bytes(destination.data() + 100, destination.size() - 100);
+
+        Assert::IsTrue(std::equal(source.begin(), source.begin() + 100, destination.begin()));
+        Assert::IsTrue(std::equal(source.begin() + 1024 * 1024 + 100, source.begin() + 2 * 1024 * 1024,
+                                  destination.begin() + 100));
+        Assert::AreEqual(2ULL * 1024 * 1024, reader.position());
+    }
+
+    TEST_METHOD(initial_read_is_small) // NOLINT
+    {
+        // Header-only readers should not pay for a large read.
+        std::vector<char> source(1024 * 1024);
+        const std::string header{"255\n"};
+        std::ranges::copy(header, source.begin());
+        buffered_stream_reader reader(create_memory_stream(source).get());
+
+        Assert::AreEqual(255U, reader.read_int());
+        Assert::IsTrue(reader.buffered_data().size() <= 4096);
+    }
+
+    TEST_METHOD(buffer_grows_while_reading) // NOLINT
+    {
+        std::vector<char> source(3 * 1024 * 1024 + 5);
+        for (size_t i{}; i != source.size(); ++i)
+        {
+            source[i] = static_cast<char>(i % 251);
+        }
+        buffered_stream_reader reader(create_memory_stream(source).get());
+
+        const auto* expected{reinterpret_cast<const std::byte*>(source.data())};
+        size_t position{};
+        int fill_count{};
+        do
+        {
+            const auto data{reader.buffered_data()};
+            Assert::IsTrue(std::equal(data.begin(), data.end(), expected + position));
+            position += data.size();
+            reader.consume(data.size());
+            ++fill_count;
+        } while (reader.fill_buffer());
+
+        Assert::AreEqual(source.size(), position);
+        Assert::IsTrue(fill_count < 16);
+    }
+
+    TEST_METHOD(read_from_memory) // NOLINT
+    {
+        const std::array source{std::byte{'1'}, std::byte{'2'}, std::byte{' '}, std::byte{5}, std::byte{6}};
+        buffered_stream_reader reader(span<const std::byte>{source});
+
+        Assert::AreEqual(12U, reader.read_int());
+        std::array<std::byte, 2> destination{};
+        reader.read_bytes(destination.data(), destination.size());
+
+        Assert::AreEqual(5, static_cast<int>(destination[0]));
+        Assert::AreEqual(6, static_cast<int>(destination[1]));
+        Assert::AreEqual(5ULL, reader.position());
+        Assert::IsTrue(reader.is_memory_backed());
+    }
+
+    TEST_METHOD(read_from_memory_beyond_end_throws) // NOLINT
+    {
+        const std::array source{std::byte{1}, std::byte{2}};
+        buffered_stream_reader reader(span<const std::byte>{source});
+
+        std::array<std::byte, 3> destination{};
+        try
+        {
+            reader.read_bytes(destination.data(), destination.size());
+            Assert::Fail();
+        }
+        catch (const winrt::hresult_error& error)
+        {
+            Assert::AreEqual(WINCODEC_ERR_STREAMREAD, static_cast<HRESULT>(error.code()));
+        }
+    }
+
 private:
     static com_ptr<IStream> create_memory_stream(span<char> source)
     {
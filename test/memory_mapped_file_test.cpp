@@ -0,0 +1,65 @@
+// SPDX-FileCopyrightText: © 2026 Team CharLS
+// SPDX-License-Identifier: BSD-3-Clause
+
+#include "intellisense.hpp"
+#include "cpp_unit_test.hpp"
+
+import std;
+import <win.hpp>;
+import winrt_base;
+
+import memory_mapped_file;
+import test_stream;
+
+using winrt::check_hresult;
+using winrt::com_ptr;
+using namespace Microsoft::VisualStudio::CppUnitTestFramework;
+
+TEST_CLASS(memory_mapped_file_test)
+{
+public:
+    TEST_METHOD(try_map_file_stream) // NOLINT
+    {
+        // Only a stream that reports an absolute path can be mapped.
+        std::array<wchar_t, MAX_PATH> path;
+        Assert::AreNotEqual(0UL, GetFullPathNameW(L"tulips-gray-8bit-512-512.pgm", static_cast<DWORD>(path.size()),
+                                                  path.data(), nullptr));
+        com_ptr<IStream> stream;
+        check_hresult(
+            SHCreateStreamOnFileEx(path.data(), STGM_READ | STGM_SHARE_DENY_WRITE, 0, false, nullptr, stream.put()));
+
+        const memory_mapped_file mapped_file{memory_mapped_file::try_map(stream.get())};
+
+        Assert::IsFalse(mapped_file.empty());
+        Assert::IsTrue(mapped_file.data().size() > 512 * 512);
+        Assert::AreEqual('P', static_cast<char>(mapped_file.data()[0]));
+        Assert::AreEqual('5', static_cast<char>(mapped_file.data()[1]));
+    }
+
+    TEST_METHOD(try_map_stream_with_other_times) // NOLINT
+    {
+        // A file of the same size with the same name is not the same file when its times differ.
+        std::array<wchar_t, MAX_PATH> path;
+        Assert::AreNotEqual(0UL, GetFullPathNameW(L"tulips-gray-8bit-512-512.pgm", static_cast<DWORD>(path.size()),
+                                                  path.data(), nullptr));
+        com_ptr<IStream> file_stream;
+        check_hresult(SHCreateStreamOnFileEx(path.data(), STGM_READ | STGM_SHARE_DENY_WRITE, 0, false, nullptr,
+                                             file_stream.put()));
+        const com_ptr stream{winrt::make<touched_stream>(file_stream)};
+
+        const memory_mapped_file mapped_file{memory_mapped_file::try_map(stream.get())};
+
+        Assert::IsTrue(mapped_file.empty());
+    }
+
+    TEST_METHOD(try_map_memory_stream) // NOLINT
+    {
+        std::array<BYTE, 4> source{'P', '5', ' ', '1'};
+        com_ptr<IStream> stream;
+        stream.attach(SHCreateMemStream(source.data(), static_cast<UINT>(source.size())));
+
+        const memory_mapped_file mapped_file{memory_mapped_file::try_map(stream.get())};
+
+        Assert::IsTrue(mapped_file.empty());
+    }
+};
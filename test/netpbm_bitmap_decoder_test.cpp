@@ -212,17 +212,28 @@ TEST_CLASS(netpbm_bitmap_decoder_test)
     TEST_METHOD(Initialize_cache_on_load) // NOLINT
     {
         com_ptr<IStream> stream;
-        stream.attach(SHCreateMemStream(nullptr, 0));
+        check_hresult(
+            SHCreateStreamOnFileEx(L"tulips-gray-8bit-512-512.pgm", STGM_READ | STGM_SHARE_DENY_WRITE, 0, false, nullptr, stream.put()));
 
         const auto result{codec_factory_.create_decoder()->Initialize(stream.get(), WICDecodeMetadataCacheOnLoad)};
         Assert::AreEqual(success_ok, result);
     }
 
-    TEST_METHOD(Initialize_twice) // NOLINT
+    TEST_METHOD(Initialize_cache_on_load_reads_header) // NOLINT
     {
         com_ptr<IStream> stream;
         stream.attach(SHCreateMemStream(nullptr, 0));
 
+        const auto result{codec_factory_.create_decoder()->Initialize(stream.get(), WICDecodeMetadataCacheOnLoad)};
+        Assert::AreEqual(wincodec::error_bad_header, result);
+    }
+
+    TEST_METHOD(Initialize_twice) // NOLINT
+    {
+        com_ptr<IStream> stream;
+        check_hresult(
+            SHCreateStreamOnFileEx(L"tulips-gray-8bit-512-512.pgm", STGM_READ | STGM_SHARE_DENY_WRITE, 0, false, nullptr, stream.put()));
+
         const com_ptr decoder{codec_factory_.create_decoder()};
         auto result{decoder->Initialize(stream.get(), WICDecodeMetadataCacheOnDemand)};
         Assert::AreEqual(success_ok, result);
@@ -269,6 +280,20 @@ TEST_CLASS(netpbm_bitmap_decoder_test)
         Assert::IsTrue(bitmap_frame_decode.get() != nullptr);
     }
 
+    TEST_METHOD(GetFrame_cache_on_demand_reads_header) // NOLINT
+    {
+        com_ptr<IStream> stream;
+        stream.attach(SHCreateMemStream(nullptr, 0));
+
+        const com_ptr decoder{codec_factory_.create_decoder()};
+        auto result{decoder->Initialize(stream.get(), WICDecodeMetadataCacheOnDemand)};
+        Assert::AreEqual(success_ok, result);
+
+        com_ptr<IWICBitmapFrameDecode> bitmap_frame_decode;
+        result = decoder->GetFrame(0, bitmap_frame_decode.put());
+        Assert::AreEqual(wincodec::error_bad_header, result);
+    }
+
     TEST_METHOD(GetFrame_with_frame_argument_null) // NOLINT
     {
         com_ptr<IStream> stream;
@@ -287,20 +312,117 @@ TEST_CLASS(netpbm_bitmap_decoder_test)
 
     TEST_METHOD(GetFrame_with_bad_index) // NOLINT
     {
+        com_ptr<IStream> stream;
+        check_hresult(
+            SHCreateStreamOnFileEx(L"tulips-gray-8bit-512-512.pgm", STGM_READ | STGM_SHARE_DENY_WRITE, 0, false, nullptr, stream.put()));
+        const com_ptr decoder{codec_factory_.create_decoder()};
+        check_hresult(decoder->Initialize(stream.get(), WICDecodeMetadataCacheOnDemand));
+
         com_ptr<IWICBitmapFrameDecode> bitmap_frame_decode;
-        const auto result{codec_factory_.create_decoder()->GetFrame(1, bitmap_frame_decode.put())};
+        const auto result{decoder->GetFrame(1, bitmap_frame_decode.put())};
 
         Assert::AreEqual(wincodec::error_frame_missing, result);
     }
 
     TEST_METHOD(GetFrame_not_initialized) // NOLINT
     {
+        for (const uint32_t index : {0U, 1U})
+        {
+            com_ptr<IWICBitmapFrameDecode> bitmap_frame_decode;
+            const auto result{codec_factory_.create_decoder()->GetFrame(index, bitmap_frame_decode.put())};
+
+            Assert::AreEqual(wincodec::error_not_initialized, result);
+        }
+    }
+
+    TEST_METHOD(GetFrameCount_multiple_frames) // NOLINT
+    {
+        const com_ptr decoder{create_decoder(multiple_frames)};
+
+        uint32_t frame_count;
+        const auto result{decoder->GetFrameCount(&frame_count)};
+
+        Assert::AreEqual(success_ok, result);
+        Assert::AreEqual(3U, frame_count);
+    }
+
+    TEST_METHOD(GetFrame_multiple_frames) // NOLINT
+    {
+        const com_ptr decoder{create_decoder(multiple_frames)};
+
         com_ptr<IWICBitmapFrameDecode> bitmap_frame_decode;
-        const auto result{codec_factory_.create_decoder()->GetFrame(0, bitmap_frame_decode.put())};
+        auto result{decoder->GetFrame(2, bitmap_frame_decode.put())};
+        Assert::AreEqual(success_ok, result);
+
+        GUID pixel_format;
+        check_hresult(bitmap_frame_decode->GetPixelFormat(&pixel_format));
+        Assert::IsTrue(GUID_WICPixelFormat24bppRGB == pixel_format);
+
+        std::array<std::byte, 3> pixel{};
+        result = bitmap_frame_decode->CopyPixels(nullptr, 3, 3, reinterpret_cast<BYTE*>(pixel.data()));
+        Assert::AreEqual(success_ok, result);
+        Assert::AreEqual(7, static_cast<int>(pixel[0]));
+        Assert::AreEqual(9, static_cast<int>(pixel[2]));
 
-        Assert::AreEqual(wincodec::error_not_initialized, result);
+        result = decoder->GetFrame(1, bitmap_frame_decode.put());
+        Assert::AreEqual(success_ok, result);
+
+        uint32_t width;
+        uint32_t height;
+        check_hresult(bitmap_frame_decode->GetSize(&width, &height));
+        Assert::AreEqual(1U, width);
+        Assert::AreEqual(2U, height);
+
+        result = decoder->GetFrame(3, bitmap_frame_decode.put());
+        Assert::AreEqual(wincodec::error_frame_missing, result);
+    }
+
+    TEST_METHOD(GetFrame_concurrent_calls_return_same_frame) // NOLINT
+    {
+        const com_ptr decoder{create_decoder(multiple_frames)};
+
+        std::array<com_ptr<IWICBitmapFrameDecode>, 8> frames;
+        {
+            std::vector<std::jthread> threads;
+            for (auto& frame : frames)
+            {
+                threads.emplace_back([&decoder, &frame] { check_hresult(decoder->GetFrame(0, frame.put())); });
+            }
+        }
+
+        for (const auto& frame : frames)
+        {
+            Assert::IsTrue(frame == frames[0]);
+        }
+    }
+
+    TEST_METHOD(GetFrameCount_ascii_frame_is_last) // NOLINT
+    {
+        const com_ptr decoder{create_decoder(std::string_view{"P2\n1 1\n255\n1\nP5\n1 1\n255\n\x02"})};
+
+        uint32_t frame_count;
+        const auto result{decoder->GetFrameCount(&frame_count)};
+
+        Assert::AreEqual(success_ok, result);
+        Assert::AreEqual(1U, frame_count);
     }
 
 private:
+    // Three binary frames stored back to back: a 2x1 graymap, a 1x2 16 bit graymap and a 1x1 pixmap.
+    static constexpr std::string_view multiple_frames{"P5\n2 1\n255\n\x01\x02"
+                                                      "P5\n1 2\n65535\n\x00\x03\x00\x04"
+                                                      "P6\n1 1\n255\n\x07\x08\x09",
+                                                      44};
+
+    [[nodiscard]] com_ptr<IWICBitmapDecoder> create_decoder(const std::string_view source) const
+    {
+        com_ptr<IStream> stream;
+        stream.attach(SHCreateMemStream(reinterpret_cast<const BYTE*>(source.data()), static_cast<UINT>(source.size())));
+
+        com_ptr decoder{codec_factory_.create_decoder()};
+        check_hresult(decoder->Initialize(stream.get(), WICDecodeMetadataCacheOnDemand));
+        return decoder;
+    }
+
     com_factory codec_factory_;
 };
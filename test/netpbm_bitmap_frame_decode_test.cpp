@@ -9,6 +9,7 @@ import <win.hpp>;
 
 import winrt_base;
 import test.hresults;
+import test.stream;
 import portable_anymap_file;
 import portable_arbitrary_map;
 import com_factory;
@@ -48,20 +49,9 @@ namespace {
             destination[j++] = (crumbs_row[i] & std::byte{0x0C}) >> 2;
             destination[j++] = crumbs_row[i] & std::byte{0x03};
         }
-        switch (width % 4)
+        for (int shift{6}; j != (row + 1) * width; shift -= 2)
         {
-        case 3:
-            destination[j++] = crumbs_row[i] >> 6;
-            [[fallthrough]];
-        case 2:
-            destination[j++] = (crumbs_row[i] & std::byte{0x30}) >> 4;
-            [[fallthrough]];
-        case 1:
-            destination[j++] = (crumbs_row[i] & std::byte{0x0C}) >> 2;
-            break;
-
-        default:
-            break;
+            destination[j++] = (crumbs_row[i] >> shift) & std::byte{0x03};
         }
     }
 
@@ -125,6 +115,59 @@ TEST_CLASS(netpbm_bitmap_frame_decode_test)
     {
         const com_ptr bitmap_frame_decoder{create_frame_decoder(L"tulips-gray-8bit-512-512.pgm")};
 
+        com_ptr<IWICBitmapSource> thumbnail;
+        const auto result = bitmap_frame_decoder->GetThumbnail(thumbnail.put());
+        Assert::AreEqual(success_ok, result);
+
+        uint32_t width;
+        uint32_t height;
+        check_hresult(thumbnail->GetSize(&width, &height));
+        Assert::AreEqual(256U, width);
+        Assert::AreEqual(256U, height);
+
+        GUID pixel_format;
+        check_hresult(thumbnail->GetPixelFormat(&pixel_format));
+        Assert::IsTrue(GUID_WICPixelFormat8bppGray == pixel_format);
+    }
+
+    TEST_METHOD(GetThumbnail_averages_blocks) // NOLINT
+    {
+        // A 512 x 2 image with 16 bit samples: every pair of columns is reduced to 1 thumbnail pixel.
+        std::string source{"P5\n512 2\n65535\n"};
+        for (uint32_t row{}; row != 2; ++row)
+        {
+            for (uint32_t column{}; column != 512; ++column)
+            {
+                source.append({static_cast<char>(column / 2), static_cast<char>(row * 255)});
+            }
+        }
+
+        const com_ptr bitmap_frame_decoder{create_frame_decoder(source)};
+
+        com_ptr<IWICBitmapSource> thumbnail;
+        auto result{bitmap_frame_decoder->GetThumbnail(thumbnail.put())};
+        Assert::AreEqual(success_ok, result);
+
+        uint32_t width;
+        uint32_t height;
+        check_hresult(thumbnail->GetSize(&width, &height));
+        Assert::AreEqual(256U, width);
+        Assert::AreEqual(1U, height);
+
+        vector<std::byte> buffer(256);
+        result = thumbnail->CopyPixels(nullptr, 256, 256, reinterpret_cast<BYTE*>(buffer.data()));
+        Assert::AreEqual(success_ok, result);
+
+        // Samples are rounded to 8 bits before they are averaged: 0x00FF is 1 and 0x64FF is 101.
+        Assert::AreEqual(1, static_cast<int>(buffer[0]));
+        Assert::AreEqual(101, static_cast<int>(buffer[100]));
+        Assert::AreEqual(255, static_cast<int>(buffer[255]));
+    }
+
+    TEST_METHOD(GetThumbnail_ascii_image) // NOLINT
+    {
+        const com_ptr bitmap_frame_decoder{create_frame_decoder(std::string{"P2\n2 1\n255\n0 255\n"})};
+
         com_ptr<IWICBitmapSource> thumbnail;
         const auto result = bitmap_frame_decoder->GetThumbnail(thumbnail.put());
         Assert::AreEqual(wincodec::error_codec_no_thumbnail, result);
@@ -222,6 +265,398 @@ TEST_CLASS(netpbm_bitmap_frame_decode_test)
         Assert::AreEqual(success_ok, result);
     }
 
+    TEST_METHOD(CopyPixels_with_rectangle) // NOLINT
+    {
+        const com_ptr bitmap_frame_decoder{create_frame_decoder(L"tulips-gray-8bit-512-512.pgm")};
+
+        const auto [width, height]{get_size(*bitmap_frame_decoder)};
+        vector<std::byte> image(static_cast<size_t>(width) * height);
+        check_hresult(copy_pixels(bitmap_frame_decoder.get(), width, image));
+
+        const WICRect rectangle{.X{100}, .Y{200}, .Width{50}, .Height{60}};
+        constexpr uint32_t stride{52};
+        vector<std::byte> buffer(static_cast<size_t>(stride) * rectangle.Height);
+        const auto result{bitmap_frame_decoder->CopyPixels(&rectangle, stride, static_cast<uint32_t>(buffer.size()),
+                                                           reinterpret_cast<BYTE*>(buffer.data()))};
+        Assert::AreEqual(success_ok, result);
+
+        for (int row{}; row != rectangle.Height; ++row)
+        {
+            const auto* expected_row{image.data() + static_cast<size_t>(rectangle.Y + row) * width + rectangle.X};
+            Assert::IsTrue(std::equal(expected_row, expected_row + rectangle.Width, buffer.data() + row * stride));
+        }
+    }
+
+    TEST_METHOD(CopyPixels_with_rectangle_16_bit_color) // NOLINT
+    {
+        const com_ptr bitmap_frame_decoder{create_frame_decoder(L"16bit_2x1.ppm")};
+
+        vector<std::uint16_t> image(2 * 3);
+        check_hresult(copy_pixels(bitmap_frame_decoder.get(), 2 * 3 * 2, image));
+
+        const WICRect rectangle{.X{1}, .Y{0}, .Width{1}, .Height{1}};
+        vector<std::uint16_t> buffer(3);
+        const auto result{bitmap_frame_decoder->CopyPixels(&rectangle, 3 * 2, static_cast<uint32_t>(buffer.size() * 2),
+                                                           reinterpret_cast<BYTE*>(buffer.data()))};
+        Assert::AreEqual(success_ok, result);
+        Assert::IsTrue(std::equal(buffer.cbegin(), buffer.cend(), image.cbegin() + 3));
+    }
+
+    TEST_METHOD(CopyPixels_with_rectangle_2_bit_monochrome) // NOLINT
+    {
+        const com_ptr bitmap_frame_decoder{create_frame_decoder(L"2bit_parrot_150x200.pgm")};
+
+        const WICRect rectangle{.X{3}, .Y{10}, .Width{7}, .Height{2}};
+        constexpr uint32_t stride{4};
+        vector<std::byte> buffer(static_cast<size_t>(stride) * rectangle.Height);
+        const auto result{bitmap_frame_decoder->CopyPixels(&rectangle, stride, static_cast<uint32_t>(buffer.size()),
+                                                           reinterpret_cast<BYTE*>(buffer.data()))};
+        Assert::AreEqual(success_ok, result);
+
+        portable_anymap_file anymap_file{"2bit_parrot_150x200.pgm"};
+        const std::vector decoded_buffer{unpack_crumbs(buffer.data(), rectangle.Width, rectangle.Height, stride)};
+        for (int row{}; row != rectangle.Height; ++row)
+        {
+            const auto* expected_row{anymap_file.image_data().data() + static_cast<size_t>(rectangle.Y + row) * 150 +
+                                     rectangle.X};
+            Assert::IsTrue(std::equal(expected_row, expected_row + rectangle.Width,
+                                      decoded_buffer.data() + static_cast<size_t>(row) * rectangle.Width));
+        }
+    }
+
+    TEST_METHOD(CopyPixels_with_rectangle_outside_image) // NOLINT
+    {
+        const com_ptr bitmap_frame_decoder{create_frame_decoder(L"tulips-gray-8bit-512-512.pgm")};
+
+        const WICRect rectangle{.X{500}, .Y{0}, .Width{50}, .Height{1}};
+        vector<BYTE> buffer(50);
+        const auto result{
+            bitmap_frame_decoder->CopyPixels(&rectangle, 50, static_cast<uint32_t>(buffer.size()), buffer.data())};
+        Assert::AreEqual(error_invalid_argument, result);
+    }
+
+    TEST_METHOD(CopyPixels_transform_rotate_90) // NOLINT
+    {
+        const com_ptr bitmap_frame_decoder{create_frame_decoder(std::string{"P5\n3 2\n255\n\x01\x02\x03\x04\x05\x06"})};
+        const auto source_transform{bitmap_frame_decoder.as<IWICBitmapSourceTransform>()};
+
+        BOOL is_supported;
+        check_hresult(source_transform->DoesSupportTransform(WICBitmapTransformRotate90, &is_supported));
+        Assert::IsTrue(is_supported == TRUE);
+
+        GUID pixel_format{GUID_WICPixelFormat8bppGray};
+        vector<std::byte> buffer(6);
+        const auto result{source_transform->CopyPixels(nullptr, 3, 2, &pixel_format, WICBitmapTransformRotate90, 2,
+                                                       static_cast<uint32_t>(buffer.size()),
+                                                       reinterpret_cast<BYTE*>(buffer.data()))};
+        Assert::AreEqual(success_ok, result);
+
+        const vector expected{std::byte{4}, std::byte{1}, std::byte{5}, std::byte{2}, std::byte{6}, std::byte{3}};
+        Assert::IsTrue(expected == buffer);
+    }
+
+    TEST_METHOD(CopyPixels_transform_flip_vertical_with_rectangle) // NOLINT
+    {
+        const com_ptr bitmap_frame_decoder{create_frame_decoder(std::string{"P5\n3 2\n255\n\x01\x02\x03\x04\x05\x06"})};
+        const auto source_transform{bitmap_frame_decoder.as<IWICBitmapSourceTransform>()};
+
+        const WICRect rectangle{.X{1}, .Y{0}, .Width{2}, .Height{2}};
+        GUID pixel_format{GUID_WICPixelFormat8bppGray};
+        vector<std::byte> buffer(4);
+        const auto result{source_transform->CopyPixels(&rectangle, 3, 2, &pixel_format, WICBitmapTransformFlipVertical, 2,
+                                                       static_cast<uint32_t>(buffer.size()),
+                                                       reinterpret_cast<BYTE*>(buffer.data()))};
+        Assert::AreEqual(success_ok, result);
+
+        const vector expected{std::byte{5}, std::byte{6}, std::byte{2}, std::byte{3}};
+        Assert::IsTrue(expected == buffer);
+    }
+
+    TEST_METHOD(CopyPixels_transform_scaled) // NOLINT
+    {
+        const com_ptr bitmap_frame_decoder{create_frame_decoder(
+            std::string{"P5\n4 2\n65535\n\x00\x01\x00\x03\x00\x05\x00\x07\x00\x03\x00\x05\x00\x07\x00\x09", 29})};
+        const auto source_transform{bitmap_frame_decoder.as<IWICBitmapSourceTransform>()};
+
+        uint32_t width{2};
+        uint32_t height{1};
+        check_hresult(source_transform->GetClosestSize(&width, &height));
+        Assert::AreEqual(2U, width);
+        Assert::AreEqual(1U, height);
+
+        GUID pixel_format{GUID_WICPixelFormat16bppGray};
+        vector<uint16_t> buffer(2);
+        const auto result{source_transform->CopyPixels(nullptr, width, height, &pixel_format, WICBitmapTransformRotate0,
+                                                       4, 4, reinterpret_cast<BYTE*>(buffer.data()))};
+        Assert::AreEqual(success_ok, result);
+
+        const vector<uint16_t> expected{3, 7};
+        Assert::IsTrue(expected == buffer);
+    }
+
+    TEST_METHOD(CopyPixels_transform_unsupported_pixel_format) // NOLINT
+    {
+        const com_ptr bitmap_frame_decoder{create_frame_decoder(std::string{"P5\n3 2\n255\n\x01\x02\x03\x04\x05\x06"})};
+        const auto source_transform{bitmap_frame_decoder.as<IWICBitmapSourceTransform>()};
+
+        GUID pixel_format{GUID_WICPixelFormat32bppBGRA};
+        vector<std::byte> buffer(24);
+        const auto result{source_transform->CopyPixels(nullptr, 3, 2, &pixel_format, WICBitmapTransformRotate0, 12,
+                                                       static_cast<uint32_t>(buffer.size()),
+                                                       reinterpret_cast<BYTE*>(buffer.data()))};
+        Assert::AreEqual(wincodec::error_unsupported_pixel_format, result);
+    }
+
+    TEST_METHOD(GetClosestPixelFormat_bgra) // NOLINT
+    {
+        const com_ptr bitmap_frame_decoder{create_frame_decoder(std::string{"P6\n1 1\n255\n\x01\x02\x03"})};
+        const auto source_transform{bitmap_frame_decoder.as<IWICBitmapSourceTransform>()};
+
+        GUID pixel_format{GUID_WICPixelFormat32bppPBGRA};
+        check_hresult(source_transform->GetClosestPixelFormat(&pixel_format));
+        Assert::IsTrue(GUID_WICPixelFormat32bppPBGRA == pixel_format);
+
+        pixel_format = GUID_WICPixelFormat32bppGrayFloat;
+        check_hresult(source_transform->GetClosestPixelFormat(&pixel_format));
+        Assert::IsTrue(GUID_WICPixelFormat24bppRGB == pixel_format);
+    }
+
+    TEST_METHOD(CopyPixels_transform_rgb_to_bgra) // NOLINT
+    {
+        const com_ptr bitmap_frame_decoder{create_frame_decoder(std::string{"P6\n2 1\n255\n\x01\x02\x03\x04\x05\x06"})};
+        const auto source_transform{bitmap_frame_decoder.as<IWICBitmapSourceTransform>()};
+
+        GUID pixel_format{GUID_WICPixelFormat32bppBGRA};
+        vector<std::byte> buffer(8);
+        const auto result{source_transform->CopyPixels(nullptr, 2, 1, &pixel_format, WICBitmapTransformRotate0, 8,
+                                                       static_cast<uint32_t>(buffer.size()),
+                                                       reinterpret_cast<BYTE*>(buffer.data()))};
+        Assert::AreEqual(success_ok, result);
+
+        const vector expected{std::byte{3}, std::byte{2}, std::byte{1}, std::byte{0xFF},
+                              std::byte{6}, std::byte{5}, std::byte{4}, std::byte{0xFF}};
+        Assert::IsTrue(expected == buffer);
+    }
+
+    TEST_METHOD(CopyPixels_transform_16_bit_to_8_bit) // NOLINT
+    {
+        const com_ptr bitmap_frame_decoder{
+            create_frame_decoder(std::string{"P5\n3 1\n65535\n\x00\x00\xFF\x00\xFF\xFF", 19})};
+        const auto source_transform{bitmap_frame_decoder.as<IWICBitmapSourceTransform>()};
+
+        GUID pixel_format{GUID_WICPixelFormat8bppGray};
+        check_hresult(source_transform->GetClosestPixelFormat(&pixel_format));
+        Assert::IsTrue(GUID_WICPixelFormat8bppGray == pixel_format);
+
+        vector<std::byte> buffer(3);
+        const auto result{source_transform->CopyPixels(nullptr, 3, 1, &pixel_format, WICBitmapTransformRotate0, 3,
+                                                       static_cast<uint32_t>(buffer.size()),
+                                                       reinterpret_cast<BYTE*>(buffer.data()))};
+        Assert::AreEqual(success_ok, result);
+
+        // 65280 / 257 = 254.01: the samples are rounded, not truncated to their high byte.
+        const vector expected{std::byte{0}, std::byte{254}, std::byte{255}};
+        Assert::IsTrue(expected == buffer);
+    }
+
+    TEST_METHOD(CopyPixels_transform_ascii_48_bit_to_24_bit) // NOLINT
+    {
+        const com_ptr bitmap_frame_decoder{create_frame_decoder(std::string{"P3\n1 1\n1000\n0 500 1000\n"})};
+        const auto source_transform{bitmap_frame_decoder.as<IWICBitmapSourceTransform>()};
+
+        GUID pixel_format{GUID_WICPixelFormat24bppRGB};
+        vector<std::byte> buffer(3);
+        const auto result{source_transform->CopyPixels(nullptr, 1, 1, &pixel_format, WICBitmapTransformRotate0, 3,
+                                                       static_cast<uint32_t>(buffer.size()),
+                                                       reinterpret_cast<BYTE*>(buffer.data()))};
+        Assert::AreEqual(success_ok, result);
+
+        const vector expected{std::byte{0}, std::byte{128}, std::byte{255}};
+        Assert::IsTrue(expected == buffer);
+    }
+
+    TEST_METHOD(CopyPixels_transform_gray_alpha_64_bit_to_32_bit) // NOLINT
+    {
+        const com_ptr bitmap_frame_decoder{create_frame_decoder(std::string{
+            "P7\nWIDTH 1\nHEIGHT 1\nDEPTH 2\nMAXVAL 65535\nTUPLTYPE GRAYSCALE_ALPHA\nENDHDR\n\x80\x00\xFF\xFF", 77})};
+        const auto source_transform{bitmap_frame_decoder.as<IWICBitmapSourceTransform>()};
+
+        GUID pixel_format{GUID_WICPixelFormat32bppRGBA};
+        vector<std::byte> buffer(4);
+        const auto result{source_transform->CopyPixels(nullptr, 1, 1, &pixel_format, WICBitmapTransformRotate0, 4,
+                                                       static_cast<uint32_t>(buffer.size()),
+                                                       reinterpret_cast<BYTE*>(buffer.data()))};
+        Assert::AreEqual(success_ok, result);
+
+        const vector expected{std::byte{128}, std::byte{128}, std::byte{128}, std::byte{255}};
+        Assert::IsTrue(expected == buffer);
+    }
+
+    TEST_METHOD(CopyPixels_transform_rgb_to_bgr_rotate_90) // NOLINT
+    {
+        const com_ptr bitmap_frame_decoder{create_frame_decoder(std::string{"P6\n2 1\n255\n\x01\x02\x03\x04\x05\x06"})};
+        const auto source_transform{bitmap_frame_decoder.as<IWICBitmapSourceTransform>()};
+
+        GUID pixel_format{GUID_WICPixelFormat24bppBGR};
+        vector<std::byte> buffer(6);
+        const auto result{source_transform->CopyPixels(nullptr, 2, 1, &pixel_format, WICBitmapTransformRotate90, 3,
+                                                       static_cast<uint32_t>(buffer.size()),
+                                                       reinterpret_cast<BYTE*>(buffer.data()))};
+        Assert::AreEqual(success_ok, result);
+
+        const vector expected{std::byte{3}, std::byte{2}, std::byte{1}, std::byte{6}, std::byte{5}, std::byte{4}};
+        Assert::IsTrue(expected == buffer);
+    }
+
+    TEST_METHOD(CopyPixels_transform_rgba_to_premultiplied_bgra) // NOLINT
+    {
+        const com_ptr bitmap_frame_decoder{create_frame_decoder(
+            std::string{"P7\nWIDTH 1\nHEIGHT 1\nDEPTH 4\nMAXVAL 255\nTUPLTYPE RGB_ALPHA\nENDHDR\n\xFF\x80\x40\x80"})};
+        const auto source_transform{bitmap_frame_decoder.as<IWICBitmapSourceTransform>()};
+
+        GUID pixel_format{GUID_WICPixelFormat32bppPBGRA};
+        vector<std::byte> buffer(4);
+        const auto result{source_transform->CopyPixels(nullptr, 1, 1, &pixel_format, WICBitmapTransformRotate0, 4,
+                                                       static_cast<uint32_t>(buffer.size()),
+                                                       reinterpret_cast<BYTE*>(buffer.data()))};
+        Assert::AreEqual(success_ok, result);
+
+        const vector expected{std::byte{32}, std::byte{64}, std::byte{128}, std::byte{0x80}};
+        Assert::IsTrue(expected == buffer);
+    }
+
+    TEST_METHOD(CopyPixels_transform_normalized_float) // NOLINT
+    {
+        const com_ptr bitmap_frame_decoder{create_frame_decoder(std::string{"P5\n3 1\n255\n\x33\xFF\x66"})};
+        const auto source_transform{bitmap_frame_decoder.as<IWICBitmapSourceTransform>()};
+
+        GUID pixel_format{GUID_WICPixelFormat32bppGrayFloat};
+        check_hresult(source_transform->GetClosestPixelFormat(&pixel_format));
+        Assert::IsTrue(GUID_WICPixelFormat32bppGrayFloat == pixel_format);
+
+        vector<float> buffer(3);
+        const auto result{source_transform->CopyPixels(nullptr, 3, 1, &pixel_format, WICBitmapTransformFlipHorizontal,
+                                                       12, 12, reinterpret_cast<BYTE*>(buffer.data()))};
+        Assert::AreEqual(success_ok, result);
+
+        Assert::AreEqual(0.4F, buffer[0], 0.0001F);
+        Assert::AreEqual(1.0F, buffer[1], 0.0001F);
+        Assert::AreEqual(0.2F, buffer[2], 0.0001F);
+    }
+
+    TEST_METHOD(CopyPixels_transform_rgb_to_rgba_float) // NOLINT
+    {
+        const com_ptr bitmap_frame_decoder{
+            create_frame_decoder(std::string{"P6\n1 1\n65535\n\xFF\xFF\x80\x00\x00\x00", 19})};
+        const auto source_transform{bitmap_frame_decoder.as<IWICBitmapSourceTransform>()};
+
+        GUID pixel_format{GUID_WICPixelFormat128bppRGBAFloat};
+        vector<float> buffer(4);
+        const auto result{source_transform->CopyPixels(nullptr, 1, 1, &pixel_format, WICBitmapTransformRotate0, 16, 16,
+                                                       reinterpret_cast<BYTE*>(buffer.data()))};
+        Assert::AreEqual(success_ok, result);
+
+        Assert::AreEqual(1.0F, buffer[0], 0.0001F);
+        Assert::AreEqual(0.5F, buffer[1], 0.0001F);
+        Assert::AreEqual(0.0F, buffer[2]);
+        Assert::AreEqual(1.0F, buffer[3]);
+    }
+
+    TEST_METHOD(DoesSupportTransform_planar) // NOLINT
+    {
+        const com_ptr bitmap_frame_decoder{create_frame_decoder(std::string{"P6\n2 1\n255\n\x01\x02\x03\x04\x05\x06"})};
+        const auto planar_transform{bitmap_frame_decoder.as<IWICPlanarBitmapSourceTransform>()};
+
+        uint32_t width{2};
+        uint32_t height{1};
+        const std::array pixel_formats{GUID_WICPixelFormat32bppGrayFloat, GUID_WICPixelFormat32bppGrayFloat,
+                                       GUID_WICPixelFormat32bppGrayFloat};
+        std::array<WICBitmapPlaneDescription, 3> plane_descriptions{};
+        BOOL is_supported;
+        check_hresult(planar_transform->DoesSupportTransform(&width, &height, WICBitmapTransformRotate0,
+                                                             WICPlanarOptionsDefault, pixel_formats.data(),
+                                                             plane_descriptions.data(), 3, &is_supported));
+        Assert::IsTrue(is_supported == TRUE);
+        Assert::AreEqual(2U, plane_descriptions[2].Width);
+        Assert::AreEqual(1U, plane_descriptions[2].Height);
+
+        check_hresult(planar_transform->DoesSupportTransform(&width, &height, WICBitmapTransformRotate0,
+                                                             WICPlanarOptionsDefault, pixel_formats.data(),
+                                                             plane_descriptions.data(), 2, &is_supported));
+        Assert::IsTrue(is_supported == FALSE);
+    }
+
+    TEST_METHOD(CopyPixels_planar) // NOLINT
+    {
+        const com_ptr bitmap_frame_decoder{create_frame_decoder(std::string{"P6\n2 1\n255\n\x01\x02\x03\x04\x05\x06"})};
+        const auto planar_transform{bitmap_frame_decoder.as<IWICPlanarBitmapSourceTransform>()};
+
+        std::array<vector<std::byte>, 3> buffers{vector<std::byte>(2), vector<std::byte>(2), vector<std::byte>(2)};
+        std::array<WICBitmapPlane, 3> planes{};
+        for (size_t i{}; i != planes.size(); ++i)
+        {
+            planes[i] = {.Format{GUID_WICPixelFormat8bppGray},
+                         .pbBuffer{reinterpret_cast<BYTE*>(buffers[i].data())},
+                         .cbStride{2},
+                         .cbBufferSize{2}};
+        }
+
+        const auto result{planar_transform->CopyPixels(nullptr, 2, 1, WICBitmapTransformFlipHorizontal,
+                                                       WICPlanarOptionsDefault, planes.data(), 3)};
+        Assert::AreEqual(success_ok, result);
+
+        Assert::IsTrue((vector{std::byte{4}, std::byte{1}}) == buffers[0]);
+        Assert::IsTrue((vector{std::byte{5}, std::byte{2}}) == buffers[1]);
+        Assert::IsTrue((vector{std::byte{6}, std::byte{3}}) == buffers[2]);
+    }
+
+    TEST_METHOD(CopyPixels_planar_normalized_float) // NOLINT
+    {
+        const com_ptr bitmap_frame_decoder{create_frame_decoder(
+            std::string{"P7\nWIDTH 1\nHEIGHT 1\nDEPTH 4\nMAXVAL 255\nTUPLTYPE RGB_ALPHA\nENDHDR\n\xFF\x33\x66\x99"})};
+        const auto planar_transform{bitmap_frame_decoder.as<IWICPlanarBitmapSourceTransform>()};
+
+        std::array<float, 4> samples{};
+        std::array<WICBitmapPlane, 4> planes{};
+        for (size_t i{}; i != planes.size(); ++i)
+        {
+            planes[i] = {.Format{GUID_WICPixelFormat32bppGrayFloat},
+                         .pbBuffer{reinterpret_cast<BYTE*>(&samples[i])},
+                         .cbStride{4},
+                         .cbBufferSize{4}};
+        }
+
+        const auto result{planar_transform->CopyPixels(nullptr, 1, 1, WICBitmapTransformRotate0,
+                                                       WICPlanarOptionsDefault, planes.data(), 4)};
+        Assert::AreEqual(success_ok, result);
+
+        Assert::AreEqual(1.0F, samples[0], 0.0001F);
+        Assert::AreEqual(0.2F, samples[1], 0.0001F);
+        Assert::AreEqual(0.4F, samples[2], 0.0001F);
+        Assert::AreEqual(0.6F, samples[3], 0.0001F);
+    }
+
+    TEST_METHOD(DoesSupportTransform_bitmap) // NOLINT
+    {
+        const com_ptr bitmap_frame_decoder{create_frame_decoder(std::string{"P4\n8 1\n\xA0", 8})};
+        const auto source_transform{bitmap_frame_decoder.as<IWICBitmapSourceTransform>()};
+
+        BOOL is_supported;
+        check_hresult(source_transform->DoesSupportTransform(WICBitmapTransformFlipHorizontal, &is_supported));
+        Assert::IsTrue(is_supported == FALSE);
+    }
+
+    TEST_METHOD(CopyPixels_buffer_too_small) // NOLINT
+    {
+        const com_ptr bitmap_frame_decoder{create_frame_decoder(L"tulips-gray-8bit-512-512.pgm")};
+
+        const auto [width, height]{get_size(*bitmap_frame_decoder)};
+        vector<BYTE> buffer(static_cast<size_t>(width) * height - 1);
+        const auto result{
+            bitmap_frame_decoder->CopyPixels(nullptr, width, static_cast<uint32_t>(buffer.size()), buffer.data())};
+        Assert::AreEqual(wincodec::error_insufficient_buffer, result);
+    }
+
     TEST_METHOD(IsIWICBitmapSource) // NOLINT
     {
         const com_ptr<IWICBitmapFrameDecode> bitmap_frame_decoder = create_frame_decoder(L"tulips-gray-8bit-512-512.pgm");
@@ -255,6 +690,30 @@ TEST_CLASS(netpbm_bitmap_frame_decode_test)
         decode_2_bit_monochrome(L"2bit_parrot_150x200.pgm", "2bit_parrot_150x200.pgm");
     }
 
+    TEST_METHOD(decode_2_bit_monochrome_multiple_bands) // NOLINT
+    {
+        // Large enough to need more than 1 band of the scratch buffer.
+        constexpr size_t width{1000};
+        constexpr size_t height{100};
+        const std::string header{"P5\n1000 100\n3\n"};
+        std::vector<char> source{header.begin(), header.end()};
+        std::vector<std::byte> expected(width * height);
+        for (size_t i{}; i != expected.size(); ++i)
+        {
+            expected[i] = static_cast<std::byte>((i / width + i % width) % 4);
+            source.push_back(static_cast<char>(expected[i]));
+        }
+
+        const com_ptr bitmap_frame_decoder{create_frame_decoder(source.data(), source.size())};
+
+        constexpr uint32_t stride{252};
+        vector<std::byte> buffer(height * stride);
+        const auto result{copy_pixels(bitmap_frame_decoder.get(), stride, buffer)};
+        Assert::AreEqual(success_ok, result);
+
+        Assert::IsTrue(expected == unpack_crumbs(buffer.data(), width, height, stride));
+    }
+
     TEST_METHOD(decode_4_bit_monochrome_4_pixels) // NOLINT
     {
         decode_4_bit_monochrome(L"4bit_4x1.pgm", "4bit_4x1.pgm");
@@ -322,6 +781,32 @@ TEST_CLASS(netpbm_bitmap_frame_decode_test)
         decode_2_byte_samples_monochrome(L"16bit_1x2.pgm", "16bit_1x2.pgm");
     }
 
+    TEST_METHOD(decode_16bit_monochrome_parallel) // NOLINT
+    {
+        // Large enough to be converted in bands by worker threads.
+        constexpr size_t width{2048};
+        constexpr size_t height{1100};
+        const std::string header{"P5\n2048 1100\n65535\n"};
+        std::vector<char> source{header.begin(), header.end()};
+        for (size_t i{}; i != width * height; ++i)
+        {
+            source.push_back(static_cast<char>(i >> 8));
+            source.push_back(static_cast<char>(i));
+        }
+
+        const com_ptr bitmap_frame_decoder{create_frame_decoder(source.data(), source.size())};
+
+        constexpr uint32_t stride{width * 2};
+        vector<std::uint16_t> buffer(width * height);
+        const auto result{copy_pixels(bitmap_frame_decoder.get(), stride, buffer)};
+        Assert::AreEqual(success_ok, result);
+
+        for (size_t i{}; i != buffer.size(); ++i)
+        {
+            Assert::AreEqual(static_cast<std::uint16_t>(i), buffer[i]);
+        }
+    }
+
     TEST_METHOD(decode_8_bit_color) // NOLINT
     {
         const com_ptr bitmap_frame_decoder{create_frame_decoder(L"jpegls-conformance-test-8bit-256-256.ppm")};
@@ -392,6 +877,155 @@ TEST_CLASS(netpbm_bitmap_frame_decode_test)
         compare("16bit_2x1.ppm", buffer);
     }
 
+    TEST_METHOD(decode_16_bit_color_multiple_bands) // NOLINT
+    {
+        // Too small for worker threads, large enough to be read and converted in more than 1 band.
+        constexpr size_t width{1000};
+        constexpr size_t height{100};
+        const std::string header{"P6\n1000 100\n65535\n"};
+        std::vector<char> source{header.begin(), header.end()};
+        for (size_t i{}; i != width * height * 3; ++i)
+        {
+            source.push_back(static_cast<char>(i >> 8));
+            source.push_back(static_cast<char>(i));
+        }
+
+        const com_ptr bitmap_frame_decoder{create_frame_decoder(source.data(), source.size())};
+
+        constexpr size_t stride_samples{width * 3 + 4};
+        vector<std::uint16_t> buffer(stride_samples * height);
+        const auto result{copy_pixels(bitmap_frame_decoder.get(), static_cast<uint32_t>(stride_samples * 2), buffer)};
+        Assert::AreEqual(success_ok, result);
+
+        for (size_t row{}; row != height; ++row)
+        {
+            for (size_t i{}; i != width * 3; ++i)
+            {
+                Assert::AreEqual(static_cast<std::uint16_t>(row * width * 3 + i), buffer[row * stride_samples + i]);
+            }
+        }
+    }
+
+    TEST_METHOD(decode_large_image_with_parallel_reads) // NOLINT
+    {
+        // Large enough to be read in bands from clones of the memory stream, when the stream is free threaded.
+        constexpr size_t width{4096};
+        constexpr size_t height{4099};
+        const std::string header{"P5\n4096 4099\n255\n"};
+        std::vector<char> source{header.begin(), header.end()};
+        source.reserve(source.size() + width * height);
+        for (size_t row{}; row != height; ++row)
+        {
+            for (size_t column{}; column != width; ++column)
+            {
+                source.push_back(static_cast<char>(row * 7 + column));
+            }
+        }
+
+        const com_ptr bitmap_frame_decoder{create_frame_decoder(source.data(), source.size())};
+
+        constexpr size_t stride{width + 4};
+        vector<std::byte> buffer(stride * height);
+        const auto result{copy_pixels(bitmap_frame_decoder.get(), static_cast<uint32_t>(stride), buffer)};
+        Assert::AreEqual(success_ok, result);
+
+        const auto* pixels{reinterpret_cast<const std::byte*>(source.data() + header.size())};
+        for (size_t row{}; row != height; ++row)
+        {
+            Assert::IsTrue(std::equal(pixels + row * width, pixels + (row + 1) * width, buffer.data() + row * stride));
+        }
+    }
+
+    TEST_METHOD(CopyPixels_concurrent_disjoint_rectangles) // NOLINT
+    {
+        constexpr size_t width{300};
+        constexpr size_t height{256};
+        const std::string header{"P5\n300 256\n255\n"};
+        std::vector<char> source{header.begin(), header.end()};
+        for (size_t i{}; i != width * height; ++i)
+        {
+            source.push_back(static_cast<char>(i / 7));
+        }
+
+        const com_ptr bitmap_frame_decoder{create_frame_decoder(source.data(), source.size())};
+
+        // Every thread decodes its own band of rows into its part of the destination.
+        constexpr size_t thread_count{8};
+        constexpr size_t band_height{height / thread_count};
+        vector<std::byte> buffer(width * height);
+        array<HRESULT, thread_count> results{};
+        {
+            std::vector<std::jthread> threads;
+            for (size_t i{}; i != thread_count; ++i)
+            {
+                threads.emplace_back([&, i] {
+                    const WICRect rectangle{.X{0},
+                                            .Y{static_cast<int32_t>(i * band_height)},
+                                            .Width{static_cast<int32_t>(width)},
+                                            .Height{static_cast<int32_t>(band_height)}};
+                    results[i] = bitmap_frame_decoder->CopyPixels(&rectangle, static_cast<uint32_t>(width),
+                                                                  static_cast<uint32_t>(width * band_height),
+                                                                  reinterpret_cast<BYTE*>(buffer.data()) +
+                                                                      i * band_height * width);
+                });
+            }
+        }
+
+        for (const HRESULT result : results)
+        {
+            Assert::AreEqual(success_ok, result);
+        }
+        Assert::IsTrue(std::equal(buffer.begin(), buffer.end(),
+                                  reinterpret_cast<const std::byte*>(source.data() + header.size())));
+    }
+
+    TEST_METHOD(CopyPixels_concurrent_frames_of_non_clonable_stream) // NOLINT
+    {
+        // The frames share the stream of the decoder: every read is serialized by the same lock.
+        constexpr size_t width{300};
+        constexpr size_t height{64};
+        const std::string header{"P5\n300 64\n255\n"};
+        std::vector<char> source;
+        for (size_t frame{}; frame != 2; ++frame)
+        {
+            source.insert(source.end(), header.begin(), header.end());
+            for (size_t i{}; i != width * height; ++i)
+            {
+                source.push_back(static_cast<char>(i / 7 + frame));
+            }
+        }
+
+        const com_ptr stream{winrt::make<non_clonable_stream>(create_memory_stream(source))};
+        const com_ptr wic_bitmap_decoder{factory_.create_decoder()};
+        check_hresult(wic_bitmap_decoder->Initialize(stream.get(), WICDecodeMetadataCacheOnDemand));
+
+        constexpr size_t thread_count{8};
+        array<vector<std::byte>, thread_count> buffers;
+        array<HRESULT, thread_count> results{};
+        {
+            std::vector<std::jthread> threads;
+            for (size_t i{}; i != thread_count; ++i)
+            {
+                threads.emplace_back([&, i] {
+                    com_ptr<IWICBitmapFrameDecode> bitmap_frame_decode;
+                    results[i] = wic_bitmap_decoder->GetFrame(static_cast<uint32_t>(i % 2), bitmap_frame_decode.put());
+                    if (results[i] != success_ok)
+                        return;
+
+                    buffers[i].resize(width * height);
+                    results[i] = copy_pixels(bitmap_frame_decode.get(), static_cast<uint32_t>(width), buffers[i]);
+                });
+            }
+        }
+
+        for (size_t i{}; i != thread_count; ++i)
+        {
+            Assert::AreEqual(success_ok, results[i]);
+            const char* expected{source.data() + (i % 2 + 1) * header.size() + i % 2 * width * height};
+            Assert::IsTrue(std::equal(buffers[i].begin(), buffers[i].end(), reinterpret_cast<const std::byte*>(expected)));
+        }
+    }
+
     TEST_METHOD(decode_16_bit_color_odd_width) // NOLINT
     {
         std::vector<char> source;
@@ -457,6 +1091,316 @@ TEST_CLASS(netpbm_bitmap_frame_decode_test)
         compare_pam("8bit_120x120_rgba.pam", buffer);
     }
 
+    TEST_METHOD(decode_8_bit_gray_alpha_pam) // NOLINT
+    {
+        const com_ptr bitmap_frame_decoder{create_frame_decoder(
+            std::string{"P7\nWIDTH 2\nHEIGHT 1\nDEPTH 2\nMAXVAL 255\nTUPLTYPE GRAYSCALE_ALPHA\nENDHDR\n\x10\x20\x30\x40",
+                        75})};
+
+        GUID pixel_format;
+        check_hresult(bitmap_frame_decoder->GetPixelFormat(&pixel_format));
+        Assert::IsTrue(GUID_WICPixelFormat32bppRGBA == pixel_format);
+
+        vector<std::byte> buffer(8);
+        const auto result{copy_pixels(bitmap_frame_decoder.get(), 8, buffer)};
+        Assert::AreEqual(success_ok, result);
+
+        const vector expected{std::byte{0x10}, std::byte{0x10}, std::byte{0x10}, std::byte{0x20},
+                              std::byte{0x30}, std::byte{0x30}, std::byte{0x30}, std::byte{0x40}};
+        Assert::IsTrue(expected == buffer);
+    }
+
+    TEST_METHOD(decode_16_bit_gray_alpha_pam) // NOLINT
+    {
+        const com_ptr bitmap_frame_decoder{create_frame_decoder(std::string{
+            "P7\nWIDTH 1\nHEIGHT 1\nDEPTH 2\nMAXVAL 65535\nTUPLTYPE GRAYSCALE_ALPHA\nENDHDR\n\x12\x34\xAB\xCD", 77})};
+
+        GUID pixel_format;
+        check_hresult(bitmap_frame_decoder->GetPixelFormat(&pixel_format));
+        Assert::IsTrue(GUID_WICPixelFormat64bppRGBA == pixel_format);
+
+        vector<uint16_t> buffer(4);
+        const auto result{copy_pixels(bitmap_frame_decoder.get(), 8, buffer)};
+        Assert::AreEqual(success_ok, result);
+
+        const vector<uint16_t> expected{0x1234, 0x1234, 0x1234, 0xABCD};
+        Assert::IsTrue(expected == buffer);
+    }
+
+    TEST_METHOD(decode_16_bit_rgba_pam) // NOLINT
+    {
+        const com_ptr bitmap_frame_decoder{create_frame_decoder(
+            std::string{"P7\nWIDTH 1\nHEIGHT 1\nDEPTH 4\nMAXVAL 65535\nENDHDR\n\x00\x01\x00\x02\x00\x03\xFF\xFF", 56})};
+
+        vector<uint16_t> buffer(4);
+        const auto result{copy_pixels(bitmap_frame_decoder.get(), 8, buffer)};
+        Assert::AreEqual(success_ok, result);
+
+        const vector<uint16_t> expected{1, 2, 3, 0xFFFF};
+        Assert::IsTrue(expected == buffer);
+    }
+
+    TEST_METHOD(decode_8bit_monochrome_with_max_value_100) // NOLINT
+    {
+        const com_ptr bitmap_frame_decoder{create_frame_decoder(std::string{"P5\n3 1\n100\n\x00\x32\x64", 14})};
+
+        GUID pixel_format;
+        check_hresult(bitmap_frame_decoder->GetPixelFormat(&pixel_format));
+        Assert::IsTrue(GUID_WICPixelFormat8bppGray == pixel_format);
+
+        vector<std::byte> buffer(3);
+        const auto result{copy_pixels(bitmap_frame_decoder.get(), 3, buffer)};
+        Assert::AreEqual(success_ok, result);
+
+        const vector expected{std::byte{0}, std::byte{128}, std::byte{255}};
+        Assert::IsTrue(expected == buffer);
+    }
+
+    TEST_METHOD(decode_16bit_color_with_max_value_1000) // NOLINT
+    {
+        const com_ptr bitmap_frame_decoder{
+            create_frame_decoder(std::string{"P6\n1 1\n1000\n\x00\x00\x01\xF4\x03\xE8", 18})};
+
+        GUID pixel_format;
+        check_hresult(bitmap_frame_decoder->GetPixelFormat(&pixel_format));
+        Assert::IsTrue(GUID_WICPixelFormat48bppRGB == pixel_format);
+
+        vector<uint16_t> buffer(3);
+        const auto result{copy_pixels(bitmap_frame_decoder.get(), 6, buffer)};
+        Assert::AreEqual(success_ok, result);
+
+        const vector<uint16_t> expected{0, 32768, 65535};
+        Assert::IsTrue(expected == buffer);
+    }
+
+    TEST_METHOD(decode_ascii_with_max_value_1000) // NOLINT
+    {
+        const com_ptr bitmap_frame_decoder{create_frame_decoder(std::string{"P2 2 1 1000 0 1000"})};
+
+        vector<uint16_t> buffer(2);
+        const auto result{copy_pixels(bitmap_frame_decoder.get(), 4, buffer)};
+        Assert::AreEqual(success_ok, result);
+
+        const vector<uint16_t> expected{0, 65535};
+        Assert::IsTrue(expected == buffer);
+    }
+
+    TEST_METHOD(decode_ascii_8bit_monochrome) // NOLINT
+    {
+        const com_ptr bitmap_frame_decoder{create_frame_decoder(std::string{"P2\n3 2\n255\n0 1 2\n 253\t254  255\n"})};
+
+        constexpr uint32_t stride{4};
+        vector<std::byte> buffer(2 * stride);
+        const auto result{copy_pixels(bitmap_frame_decoder.get(), stride, buffer)};
+        Assert::AreEqual(success_ok, result);
+
+        Assert::AreEqual(0, static_cast<int>(buffer[0]));
+        Assert::AreEqual(1, static_cast<int>(buffer[1]));
+        Assert::AreEqual(2, static_cast<int>(buffer[2]));
+        Assert::AreEqual(253, static_cast<int>(buffer[4]));
+        Assert::AreEqual(254, static_cast<int>(buffer[5]));
+        Assert::AreEqual(255, static_cast<int>(buffer[6]));
+    }
+
+    TEST_METHOD(decode_ascii_16bit_color) // NOLINT
+    {
+        const com_ptr bitmap_frame_decoder{create_frame_decoder(std::string{"P3 1 2 65535 1 2 3 65535 300 4000"})};
+
+        vector<uint16_t> buffer(6);
+        const auto result{copy_pixels(bitmap_frame_decoder.get(), 6, buffer)};
+        Assert::AreEqual(success_ok, result);
+
+        const vector<uint16_t> expected{1, 2, 3, 65535, 300, 4000};
+        Assert::IsTrue(expected == buffer);
+    }
+
+    TEST_METHOD(decode_ascii_with_rectangle) // NOLINT
+    {
+        const com_ptr bitmap_frame_decoder{
+            create_frame_decoder(std::string{"P2\n4 3\n255\n1 2 3 4\n5 6 7 8\n9 10 11 12\n"})};
+
+        const WICRect rectangle{.X{1}, .Y{1}, .Width{2}, .Height{2}};
+        vector<std::byte> buffer(4);
+        const auto result{bitmap_frame_decoder->CopyPixels(&rectangle, 2, static_cast<uint32_t>(buffer.size()),
+                                                           reinterpret_cast<BYTE*>(buffer.data()))};
+        Assert::AreEqual(success_ok, result);
+
+        Assert::AreEqual(6, static_cast<int>(buffer[0]));
+        Assert::AreEqual(7, static_cast<int>(buffer[1]));
+        Assert::AreEqual(10, static_cast<int>(buffer[2]));
+        Assert::AreEqual(11, static_cast<int>(buffer[3]));
+    }
+
+    TEST_METHOD(decode_ascii_invalid_character) // NOLINT
+    {
+        const com_ptr bitmap_frame_decoder{create_frame_decoder(std::string{"P2\n2 1\n255\n1 x\n"})};
+
+        vector<std::byte> buffer(2);
+        const auto result{copy_pixels(bitmap_frame_decoder.get(), 2, buffer)};
+        Assert::AreEqual(wincodec::error_bad_image, result);
+    }
+
+    TEST_METHOD(decode_ascii_in_strips) // NOLINT
+    {
+        // Strips are decoded top-down and bottom-up: later strips start at the recorded row positions.
+        constexpr int32_t width{3};
+        constexpr int32_t height{200};
+        std::string source{std::format("P2\n{} {}\n255\n", width, height)};
+        for (int32_t i{}; i != width * height; ++i)
+        {
+            source += std::format("{}{}", i % 256, i % width == width - 1 ? "\n" : " ");
+        }
+        const com_ptr bitmap_frame_decoder{create_frame_decoder(source)};
+
+        constexpr int32_t strip_height{7};
+        vector<std::byte> buffer(width * strip_height);
+        for (const bool bottom_up : {false, true})
+        {
+            for (int32_t strip{}; strip * strip_height < height; ++strip)
+            {
+                const int32_t y{bottom_up ? (height - 1) / strip_height * strip_height - strip * strip_height
+                                          : strip * strip_height};
+                const WICRect rectangle{.X{}, .Y{y}, .Width{width}, .Height{std::min(strip_height, height - y)}};
+                check_hresult(bitmap_frame_decoder->CopyPixels(&rectangle, width,
+                                                               static_cast<uint32_t>(buffer.size()),
+                                                               reinterpret_cast<BYTE*>(buffer.data())));
+
+                for (int32_t i{}; i != rectangle.Width * rectangle.Height; ++i)
+                {
+                    Assert::AreEqual((y * width + i) % 256, static_cast<int>(buffer[i]));
+                }
+            }
+        }
+    }
+
+    TEST_METHOD(decode_ascii_too_few_samples) // NOLINT
+    {
+        const com_ptr bitmap_frame_decoder{create_frame_decoder(std::string{"P2\n2 2\n255\n1 2 3"})};
+
+        vector<std::byte> buffer(4);
+        const auto result{copy_pixels(bitmap_frame_decoder.get(), 2, buffer)};
+        Assert::AreEqual(wincodec::error_stream_read, result);
+    }
+
+    TEST_METHOD(decode_truncated_stream) // NOLINT
+    {
+        // The pixels are read from a memory stream, not from a memory mapped file.
+        const com_ptr bitmap_frame_decoder{create_frame_decoder(std::string{"P5\n3 2\n255\n\x01\x02\x03\x04"})};
+
+        vector<std::byte> buffer(6);
+        const auto result{copy_pixels(bitmap_frame_decoder.get(), 3, buffer)};
+        Assert::AreEqual(wincodec::error_stream_read, result);
+    }
+
+    TEST_METHOD(decode_1bit_bitmap) // NOLINT
+    {
+        // The padding bits of the last byte of the first row are set, they must be cleared.
+        const com_ptr bitmap_frame_decoder{create_frame_decoder(std::string{"P4\n10 2\n\xA0\xFF\x0F\x40", 12})};
+
+        GUID pixel_format;
+        check_hresult(bitmap_frame_decoder->GetPixelFormat(&pixel_format));
+        Assert::IsTrue(GUID_WICPixelFormatBlackWhite == pixel_format);
+
+        constexpr uint32_t stride{4};
+        vector<std::byte> buffer(2 * stride);
+        const auto result{copy_pixels(bitmap_frame_decoder.get(), stride, buffer)};
+        Assert::AreEqual(success_ok, result);
+
+        Assert::AreEqual(0x5F, static_cast<int>(buffer[0]));
+        Assert::AreEqual(0x00, static_cast<int>(buffer[1]));
+        Assert::AreEqual(0xF0, static_cast<int>(buffer[4]));
+        Assert::AreEqual(0x80, static_cast<int>(buffer[5]));
+    }
+
+    TEST_METHOD(decode_1bit_bitmap_with_rectangle) // NOLINT
+    {
+        const com_ptr bitmap_frame_decoder{create_frame_decoder(std::string{"P4\n10 2\n\xA0\xFF\x0F\x40", 12})};
+
+        const WICRect rectangle{.X{3}, .Y{0}, .Width{6}, .Height{2}};
+        vector<std::byte> buffer(2);
+        const auto result{bitmap_frame_decoder->CopyPixels(&rectangle, 1, static_cast<uint32_t>(buffer.size()),
+                                                           reinterpret_cast<BYTE*>(buffer.data()))};
+        Assert::AreEqual(success_ok, result);
+
+        Assert::AreEqual(0xF8, static_cast<int>(buffer[0]));
+        Assert::AreEqual(0x84, static_cast<int>(buffer[1]));
+    }
+
+    TEST_METHOD(decode_ascii_1bit_bitmap) // NOLINT
+    {
+        const com_ptr bitmap_frame_decoder{
+            create_frame_decoder(std::string{"P1\n10 2\n1010000011\n0 0 0 0 1 1 1 1 0 1\n"})};
+
+        constexpr uint32_t stride{2};
+        vector<std::byte> buffer(2 * stride);
+        const auto result{copy_pixels(bitmap_frame_decoder.get(), stride, buffer)};
+        Assert::AreEqual(success_ok, result);
+
+        Assert::AreEqual(0x5F, static_cast<int>(buffer[0]));
+        Assert::AreEqual(0x00, static_cast<int>(buffer[1]));
+        Assert::AreEqual(0xF0, static_cast<int>(buffer[2]));
+        Assert::AreEqual(0x80, static_cast<int>(buffer[3]));
+    }
+
+    TEST_METHOD(decode_ascii_1bit_bitmap_invalid_character) // NOLINT
+    {
+        const com_ptr bitmap_frame_decoder{create_frame_decoder(std::string{"P1\n2 1\n12\n"})};
+
+        vector<std::byte> buffer(1);
+        const auto result{copy_pixels(bitmap_frame_decoder.get(), 1, buffer)};
+        Assert::AreEqual(wincodec::error_bad_image, result);
+    }
+
+    TEST_METHOD(decode_little_endian_float_gray) // NOLINT
+    {
+        // Rows are stored bottom-to-top in PFM files.
+        const com_ptr bitmap_frame_decoder{create_frame_decoder(create_pfm("Pf\n2 2\n-1.0\n", {3, 4, 1, 2}, false))};
+
+        GUID pixel_format;
+        check_hresult(bitmap_frame_decoder->GetPixelFormat(&pixel_format));
+        Assert::IsTrue(GUID_WICPixelFormat32bppGrayFloat == pixel_format);
+
+        vector<float> buffer(4);
+        const auto result{copy_pixels(bitmap_frame_decoder.get(), 8, buffer)};
+        Assert::AreEqual(success_ok, result);
+
+        const vector<float> expected{1, 2, 3, 4};
+        Assert::IsTrue(expected == buffer);
+    }
+
+    TEST_METHOD(decode_big_endian_float_color) // NOLINT
+    {
+        const com_ptr bitmap_frame_decoder{
+            create_frame_decoder(create_pfm("PF\n1 2\n1.0\n", {4, 5, 6, 1, 2, 3}, true))};
+
+        GUID pixel_format;
+        check_hresult(bitmap_frame_decoder->GetPixelFormat(&pixel_format));
+        Assert::IsTrue(GUID_WICPixelFormat96bppRGBFloat == pixel_format);
+
+        vector<float> buffer(6);
+        const auto result{copy_pixels(bitmap_frame_decoder.get(), 12, buffer)};
+        Assert::AreEqual(success_ok, result);
+
+        const vector<float> expected{1, 2, 3, 4, 5, 6};
+        Assert::IsTrue(expected == buffer);
+    }
+
+    TEST_METHOD(decode_float_with_rectangle) // NOLINT
+    {
+        const com_ptr bitmap_frame_decoder{
+            create_frame_decoder(create_pfm("Pf\n3 3\n1.0\n", {7, 8, 9, 4, 5, 6, 1, 2, 3}, true))};
+
+        const WICRect rectangle{.X{1}, .Y{1}, .Width{2}, .Height{2}};
+        vector<float> buffer(4);
+        const auto result{bitmap_frame_decoder->CopyPixels(&rectangle, 8,
+                                                           static_cast<uint32_t>(buffer.size() * sizeof(float)),
+                                                           reinterpret_cast<BYTE*>(buffer.data()))};
+        Assert::AreEqual(success_ok, result);
+
+        const vector<float> expected{5, 6, 8, 9};
+        Assert::IsTrue(expected == buffer);
+    }
+
 private:
     void decode_2_bit_monochrome(_Null_terminated_ const wchar_t* filename_actual,
                                  _Null_terminated_ const char* filename_expected) const
@@ -534,6 +1478,11 @@ TEST_CLASS(netpbm_bitmap_frame_decode_test)
         return bitmap_frame_decode;
     }
 
+    [[nodiscard]] com_ptr<IWICBitmapFrameDecode> create_frame_decoder(std::string source) const
+    {
+        return create_frame_decoder(source.data(), source.size());
+    }
+
     [[nodiscard]] static com_ptr<IWICImagingFactory> imaging_factory()
     {
         com_ptr<IWICImagingFactory> imaging_factory;
@@ -558,6 +1507,29 @@ TEST_CLASS(netpbm_bitmap_frame_decode_test)
                                    static_cast<BYTE*>(data));
     }
 
+    [[nodiscard]] static HRESULT copy_pixels(IWICBitmapFrameDecode * decoder, const uint32_t stride,
+                                             const span<float> buffer)
+    {
+        void* data = buffer.data();
+        return decoder->CopyPixels(nullptr, stride, static_cast<uint32_t>(buffer.size()) * sizeof(float),
+                                   static_cast<BYTE*>(data));
+    }
+
+    [[nodiscard]] static std::string create_pfm(std::string header, const std::initializer_list<float> samples,
+                                                 const bool big_endian)
+    {
+        for (const float sample : samples)
+        {
+            auto bytes{std::bit_cast<array<char, sizeof(float)>>(sample)};
+            if (big_endian)
+                std::ranges::reverse(bytes);
+
+            header.append(bytes.data(), bytes.size());
+        }
+
+        return header;
+    }
+
     constexpr static void convert_to_little_endian_and_shift(span<uint16_t> samples, const uint32_t sample_shift) noexcept
     {
         std::ranges::transform(samples, samples.begin(), [sample_shift](const uint16_t sample) noexcept -> uint16_t {
@@ -0,0 +1,134 @@
+// SPDX-FileCopyrightText: © 2026 Team CharLS
+// SPDX-License-Identifier: BSD-3-Clause
+
+#include "cpp_unit_test.hpp"
+
+import std;
+
+import pixel_transform;
+
+using std::uint16_t;
+using std::vector;
+using namespace Microsoft::VisualStudio::CppUnitTestFramework;
+
+TEST_CLASS(pixel_transform_test)
+{
+public:
+    TEST_METHOD(copy_pixels_transformed_rotate_90) // NOLINT
+    {
+        // 3 x 2 source, rotated clockwise into a 2 x 3 destination.
+        const vector<std::byte> source{std::byte{1}, std::byte{2}, std::byte{3},
+                                       std::byte{4}, std::byte{5}, std::byte{6}};
+        vector<std::byte> destination(6);
+
+        // Source pixel (x, y) is stored at destination (1 - y, x).
+        copy_pixels_transformed(source.data(), 3, 3, 2, 1, destination.data() + 1, 2, -1);
+
+        const vector<std::byte> expected{std::byte{4}, std::byte{1}, std::byte{5},
+                                         std::byte{2}, std::byte{6}, std::byte{3}};
+        Assert::IsTrue(expected == destination);
+    }
+
+    TEST_METHOD(copy_pixels_transformed_flip_horizontal) // NOLINT
+    {
+        const vector<uint16_t> source{1, 2, 3, 4, 5, 6};
+        vector<uint16_t> destination(6);
+
+        copy_pixels_transformed(reinterpret_cast<const std::byte*>(source.data()), 6, 3, 2, 2,
+                                reinterpret_cast<std::byte*>(destination.data() + 2), -2, 6);
+
+        const vector<uint16_t> expected{3, 2, 1, 6, 5, 4};
+        Assert::IsTrue(expected == destination);
+    }
+
+    TEST_METHOD(copy_pixels_transformed_transpose_multiple_blocks) // NOLINT
+    {
+        constexpr size_t width{70};
+        constexpr size_t height{40};
+        vector<uint16_t> source(width * height);
+        std::iota(source.begin(), source.end(), uint16_t{});
+        vector<uint16_t> destination(width * height);
+
+        copy_pixels_transformed(reinterpret_cast<const std::byte*>(source.data()), width * 2, width, height, 2,
+                                reinterpret_cast<std::byte*>(destination.data()), height * 2, 2);
+
+        for (size_t y{}; y != height; ++y)
+        {
+            for (size_t x{}; x != width; ++x)
+            {
+                Assert::AreEqual(source[y * width + x], destination[x * height + y]);
+            }
+        }
+    }
+
+    TEST_METHOD(downscale_rows_16_bit) // NOLINT
+    {
+        const vector<uint16_t> source{1, 3, 5, 7, 9, 3, 5, 7, 9, 11};
+        vector<uint16_t> destination(3);
+
+        downscale_rows(reinterpret_cast<const std::byte*>(source.data()), 10, 2, 5, 2, 1, 16,
+                       reinterpret_cast<std::byte*>(destination.data()));
+
+        const vector<uint16_t> expected{3, 7, 10};
+        Assert::IsTrue(expected == destination);
+    }
+
+    TEST_METHOD(downscale_rows_8_bit_color) // NOLINT
+    {
+        const vector<std::byte> source{std::byte{10}, std::byte{20}, std::byte{30},
+                                       std::byte{20}, std::byte{40}, std::byte{60}};
+        vector<std::byte> destination(3);
+
+        downscale_rows(source.data(), 6, 1, 2, 2, 3, 8, destination.data());
+
+        const vector<std::byte> expected{std::byte{15}, std::byte{30}, std::byte{45}};
+        Assert::IsTrue(expected == destination);
+    }
+
+    TEST_METHOD(downscale_rows_float) // NOLINT
+    {
+        const vector<float> source{1.0F, 2.0F, 3.0F, 4.0F};
+        vector<float> destination(1);
+
+        downscale_rows(reinterpret_cast<const std::byte*>(source.data()), 8, 2, 2, 2, 1, 32,
+                       reinterpret_cast<std::byte*>(destination.data()));
+
+        Assert::AreEqual(2.5F, destination[0]);
+    }
+
+    TEST_METHOD(convert_to_8_bit_samples_16_bit) // NOLINT
+    {
+        const vector<uint16_t> source{0, 128, 129, 32896, 65535};
+        vector<std::byte> destination(5);
+
+        convert_to_8_bit_samples(reinterpret_cast<const std::byte*>(source.data()), 5, 16, destination.data());
+
+        const vector<std::byte> expected{std::byte{0}, std::byte{0}, std::byte{1}, std::byte{128}, std::byte{255}};
+        Assert::IsTrue(expected == destination);
+    }
+
+    TEST_METHOD(convert_to_8_bit_samples_2_bit) // NOLINT
+    {
+        // The samples are packed starting at the high bits: 0, 1, 2, 3 and 3.
+        const vector<std::byte> source{std::byte{0x1B}, std::byte{0xC0}};
+        vector<std::byte> destination(5);
+
+        convert_to_8_bit_samples(source.data(), 5, 2, destination.data());
+
+        const vector<std::byte> expected{std::byte{0}, std::byte{85}, std::byte{170}, std::byte{255}, std::byte{255}};
+        Assert::IsTrue(expected == destination);
+    }
+
+    TEST_METHOD(convert_to_8_bit_samples_1_bit_then_downscale) // NOLINT
+    {
+        // A thumbnail pixel is the average of the 8 bit samples: 3 of 4 white pixels average to 191.
+        const vector<std::byte> source{std::byte{0b1011'0000}};
+        vector<std::byte> samples(4);
+        vector<std::byte> destination(1);
+
+        convert_to_8_bit_samples(source.data(), 4, 1, samples.data());
+        downscale_rows(samples.data(), 4, 1, 4, 4, 1, 8, destination.data());
+
+        Assert::AreEqual(191, std::to_integer<int>(destination[0]));
+    }
+};
@@ -26,7 +26,7 @@ TEST_CLASS(pnm_header_test)
         const com_ptr stream{create_memory_stream(initial_values)};
 
         const bool result{is_pnm_file(stream.get())};
-        Assert::IsFalse(result);
+        Assert::IsTrue(result);
     }
 
     TEST_METHOD(is_pnm_file_for_p2) // NOLINT
@@ -35,7 +35,7 @@ TEST_CLASS(pnm_header_test)
         const com_ptr stream{create_memory_stream(initial_values)};
 
         const bool result{is_pnm_file(stream.get())};
-        Assert::IsFalse(result);
+        Assert::IsTrue(result);
     }
 
     TEST_METHOD(is_pnm_file_for_p3) // NOLINT
@@ -44,7 +44,7 @@ TEST_CLASS(pnm_header_test)
         const com_ptr stream{create_memory_stream(initial_values)};
 
         const bool result{is_pnm_file(stream.get())};
-        Assert::IsFalse(result);
+        Assert::IsTrue(result);
     }
 
     TEST_METHOD(is_pnm_file_for_p4) // NOLINT
@@ -53,7 +53,7 @@ TEST_CLASS(pnm_header_test)
         const com_ptr stream{create_memory_stream(initial_values)};
 
         const bool result{is_pnm_file(stream.get())};
-        Assert::IsFalse(result);
+        Assert::IsTrue(result);
     }
 
     TEST_METHOD(is_pnm_file_for_p5) // NOLINT
@@ -83,6 +83,15 @@ TEST_CLASS(pnm_header_test)
         Assert::IsTrue(result);
     }
 
+    TEST_METHOD(is_pnm_file_for_pf) // NOLINT
+    {
+        constexpr array initial_values{byte{'P'}, byte{'F'}};
+        const com_ptr stream{create_memory_stream(initial_values)};
+
+        const bool result{is_pnm_file(stream.get())};
+        Assert::IsTrue(result);
+    }
+
     TEST_METHOD(parse_pam) // NOLINT
     {
         std::vector<char> source;
@@ -109,4 +118,115 @@ TEST_CLASS(pnm_header_test)
         Assert::AreEqual(static_cast<USHORT>(255U), header.MaxColorValue);
         Assert::IsTrue(PnmType::ArbitraryMap == header.PnmType);
     }
+
+    TEST_METHOD(parse_pam_grayscale_alpha) // NOLINT
+    {
+        std::string source{"P7\nWIDTH 3\nHEIGHT 2\nDEPTH 2\nMAXVAL 65535\nTUPLTYPE GRAYSCALE_ALPHA\nENDHDR\n"};
+        const com_ptr stream{create_memory_stream(source.data(), source.size())};
+
+        buffered_stream_reader reader{stream.get()};
+        const pnm_header header{reader};
+
+        Assert::AreEqual(3U, header.width);
+        Assert::AreEqual(2U, header.height);
+        Assert::AreEqual(2U, header.depth);
+        Assert::AreEqual(static_cast<USHORT>(65535U), header.MaxColorValue);
+        Assert::IsTrue(PnmType::ArbitraryMap == header.PnmType);
+    }
+
+    TEST_METHOD(parse_pam_rgb) // NOLINT
+    {
+        std::string source{"P7\nWIDTH 3\nHEIGHT 2\nDEPTH 3\nMAXVAL 255\nTUPLTYPE RGB\nENDHDR\n"};
+        const com_ptr stream{create_memory_stream(source.data(), source.size())};
+
+        buffered_stream_reader reader{stream.get()};
+        const pnm_header header{reader};
+
+        Assert::AreEqual(3U, header.depth);
+        Assert::IsTrue(PnmType::Pixmap == header.PnmType);
+    }
+
+    TEST_METHOD(parse_pam_depth_does_not_match_tuple_type) // NOLINT
+    {
+        std::string source{"P7\nWIDTH 3\nHEIGHT 2\nDEPTH 4\nMAXVAL 255\nTUPLTYPE RGB\nENDHDR\n"};
+        const com_ptr stream{create_memory_stream(source.data(), source.size())};
+
+        buffered_stream_reader reader{stream.get()};
+        try
+        {
+            const pnm_header header{reader};
+            Assert::Fail();
+        }
+        catch (const winrt::hresult_error& error)
+        {
+            Assert::AreEqual(WINCODEC_ERR_BADHEADER, static_cast<HRESULT>(error.code()));
+        }
+    }
+
+    TEST_METHOD(parse_pam_max_value_out_of_range) // NOLINT
+    {
+        for (const std::string max_value : {"0", "65536", "65537"})
+        {
+            std::string source{"P7\nWIDTH 3\nHEIGHT 2\nDEPTH 1\nMAXVAL " + max_value + "\nENDHDR\n"};
+            const com_ptr stream{create_memory_stream(source.data(), source.size())};
+
+            buffered_stream_reader reader{stream.get()};
+            try
+            {
+                const pnm_header header{reader};
+                Assert::Fail();
+            }
+            catch (const winrt::hresult_error& error)
+            {
+                Assert::AreEqual(WINCODEC_ERR_BADHEADER, static_cast<HRESULT>(error.code()));
+            }
+        }
+    }
+
+    TEST_METHOD(parse_pfm_little_endian) // NOLINT
+    {
+        std::string source{"PF\n3 2\n-1.0\n"};
+        const com_ptr stream{create_memory_stream(source.data(), source.size())};
+
+        buffered_stream_reader reader{stream.get()};
+        const pnm_header header{reader};
+
+        Assert::AreEqual(3U, header.width);
+        Assert::AreEqual(2U, header.height);
+        Assert::AreEqual(3U, header.depth);
+        Assert::IsTrue(header.FloatFormat);
+        Assert::IsTrue(header.LittleEndian);
+        Assert::IsTrue(PnmType::Pixmap == header.PnmType);
+    }
+
+    TEST_METHOD(parse_pfm_big_endian_grayscale) // NOLINT
+    {
+        std::string source{"Pf\n3 2\n1.0\n"};
+        const com_ptr stream{create_memory_stream(source.data(), source.size())};
+
+        buffered_stream_reader reader{stream.get()};
+        const pnm_header header{reader};
+
+        Assert::AreEqual(1U, header.depth);
+        Assert::IsTrue(header.FloatFormat);
+        Assert::IsFalse(header.LittleEndian);
+        Assert::IsTrue(PnmType::Graymap == header.PnmType);
+    }
+
+    TEST_METHOD(parse_pfm_zero_scale) // NOLINT
+    {
+        std::string source{"PF\n3 2\n0.0\n"};
+        const com_ptr stream{create_memory_stream(source.data(), source.size())};
+
+        buffered_stream_reader reader{stream.get()};
+        try
+        {
+            const pnm_header header{reader};
+            Assert::Fail();
+        }
+        catch (const winrt::hresult_error& error)
+        {
+            Assert::AreEqual(WINCODEC_ERR_BADHEADER, static_cast<HRESULT>(error.code()));
+        }
+    }
 };
@@ -0,0 +1,389 @@
+// SPDX-FileCopyrightText: © 2026 Team CharLS
+// SPDX-License-Identifier: BSD-3-Clause
+
+#include "cpp_unit_test.hpp"
+
+import std;
+
+import sample_conversion;
+
+using std::uint16_t;
+using std::vector;
+using namespace Microsoft::VisualStudio::CppUnitTestFramework;
+
+namespace {
+
+[[nodiscard]] vector<uint16_t> create_test_samples(const size_t count)
+{
+    vector<uint16_t> samples(count);
+    std::mt19937 generator{static_cast<std::uint32_t>(count)};
+    std::uniform_int_distribution<int> distribution{0, 0xFFFF};
+    std::ranges::generate(samples, [&] { return static_cast<uint16_t>(distribution(generator)); });
+
+    return samples;
+}
+
+[[nodiscard]] vector<std::byte> create_test_samples(const size_t count, const int bits_per_sample)
+{
+    vector<std::byte> samples(count);
+    std::mt19937 generator{static_cast<std::uint32_t>(count)};
+    std::uniform_int_distribution<int> distribution{0, (1 << bits_per_sample) - 1};
+    std::ranges::generate(samples, [&] { return static_cast<std::byte>(distribution(generator)); });
+
+    return samples;
+}
+
+} // namespace
+
+
+TEST_CLASS(sample_conversion_test)
+{
+public:
+    TEST_METHOD_INITIALIZE(initialize) // NOLINT
+    {
+        initialize_sample_conversion();
+    }
+
+    TEST_METHOD(convert_to_little_endian_swaps_bytes) // NOLINT
+    {
+        vector<uint16_t> samples{0x0102, 0xA0B0, 0xFF00};
+
+        convert_to_little_endian(samples);
+
+        Assert::AreEqual(static_cast<uint16_t>(0x0201), samples[0]);
+        Assert::AreEqual(static_cast<uint16_t>(0xB0A0), samples[1]);
+        Assert::AreEqual(static_cast<uint16_t>(0x00FF), samples[2]);
+    }
+
+    TEST_METHOD(convert_to_little_endian_and_shift_matches_scalar) // NOLINT
+    {
+        // Cover all vector widths and all tail lengths.
+        for (size_t count{}; count != 130; ++count)
+        {
+            for (const std::uint32_t sample_shift : {0U, 4U, 6U})
+            {
+                vector actual{create_test_samples(count)};
+                vector expected{actual};
+
+                convert_to_little_endian_and_shift(actual, sample_shift);
+                convert_to_little_endian_and_shift_scalar(expected, sample_shift);
+
+                Assert::IsTrue(expected == actual);
+            }
+        }
+    }
+
+    TEST_METHOD(pack_to_crumbs_partial_byte) // NOLINT
+    {
+        const vector samples{std::byte{3}, std::byte{2}, std::byte{1}, std::byte{0}, std::byte{1}, std::byte{2}};
+        vector<std::byte> packed(2);
+
+        pack_to_crumbs(samples, packed.data());
+
+        Assert::AreEqual(0b11'10'01'00, std::to_integer<int>(packed[0]));
+        Assert::AreEqual(0b01'10'00'00, std::to_integer<int>(packed[1]));
+    }
+
+    TEST_METHOD(pack_to_crumbs_matches_scalar) // NOLINT
+    {
+        for (size_t count{}; count != 300; ++count)
+        {
+            const vector samples{create_test_samples(count, 2)};
+            vector<std::byte> actual((count + 3) / 4);
+            vector<std::byte> expected(actual.size());
+
+            pack_to_crumbs(samples, actual.data());
+            pack_to_crumbs_scalar(samples, expected.data());
+
+            Assert::IsTrue(expected == actual);
+        }
+    }
+
+    TEST_METHOD(pack_to_nibbles_matches_scalar) // NOLINT
+    {
+        for (size_t count{}; count != 150; ++count)
+        {
+            const vector samples{create_test_samples(count, 4)};
+            vector<std::byte> actual((count + 1) / 2);
+            vector<std::byte> expected(actual.size());
+
+            pack_to_nibbles(samples, actual.data());
+            pack_to_nibbles_scalar(samples, expected.data());
+
+            Assert::IsTrue(expected == actual);
+        }
+    }
+
+    TEST_METHOD(convert_to_bgr_premultiplies) // NOLINT
+    {
+        vector pixels{std::byte{0xFF}, std::byte{0x80}, std::byte{0x40}, std::byte{0x80}};
+
+        convert_to_bgr(bgr_conversion::rgba_to_premultiplied_bgra, pixels.data(), 1);
+
+        const vector expected{std::byte{32}, std::byte{64}, std::byte{128}, std::byte{0x80}};
+        Assert::IsTrue(expected == pixels);
+    }
+
+    TEST_METHOD(convert_to_bgr_matches_scalar) // NOLINT
+    {
+        for (const auto conversion : {bgr_conversion::rgb_to_bgr, bgr_conversion::rgb_to_bgra,
+                                      bgr_conversion::rgba_to_bgra, bgr_conversion::rgba_to_premultiplied_bgra})
+        {
+            for (size_t count{}; count != 70; ++count)
+            {
+                // The 3 byte pixels of rgb_to_bgra are stored after count bytes, the other conversions are in place.
+                vector actual{create_test_samples(count * 4, 8)};
+                vector expected{actual};
+
+                convert_to_bgr(conversion, actual.data(), count);
+                convert_to_bgr_scalar(conversion, expected.data(), count);
+
+                Assert::IsTrue(expected == actual);
+            }
+        }
+    }
+
+    TEST_METHOD(convert_to_float_matches_scalar) // NOLINT
+    {
+        for (size_t count{}; count != 70; ++count)
+        {
+            for (const std::uint32_t bits_per_sample : {8U, 16U})
+            {
+                const vector samples{create_test_samples(count * bits_per_sample / 8, 8)};
+                const float scale{bits_per_sample == 8 ? 1.0F / 255 : 1.0F / 1000};
+                vector<float> actual(count);
+                vector<float> expected(count);
+
+                convert_to_float(samples, bits_per_sample, scale, actual.data());
+                convert_to_float_scalar(samples, bits_per_sample, scale, expected.data());
+
+                Assert::IsTrue(expected == actual);
+            }
+        }
+    }
+
+    TEST_METHOD(expand_rgb_to_rgba_matches_scalar) // NOLINT
+    {
+        for (size_t count{}; count != 30; ++count)
+        {
+            vector<float> actual(count * 4);
+            std::iota(actual.begin() + static_cast<std::ptrdiff_t>(count), actual.end(), 0.5F);
+            vector expected{actual};
+
+            expand_rgb_to_rgba(actual.data(), count);
+            expand_rgb_to_rgba_scalar(expected.data(), count);
+
+            Assert::IsTrue(expected == actual);
+        }
+    }
+
+    TEST_METHOD(deinterleave_matches_scalar) // NOLINT
+    {
+        for (const size_t samples_per_pixel : {3U, 4U})
+        {
+            for (const size_t sample_size : {1U, 2U, 4U})
+            {
+                for (size_t count{}; count != 70; ++count)
+                {
+                    const vector pixels{create_test_samples(count * samples_per_pixel * sample_size, 8)};
+                    vector<std::byte> actual(count * samples_per_pixel * sample_size);
+                    vector<std::byte> expected(actual.size());
+                    std::array<std::byte*, 4> actual_planes{};
+                    std::array<std::byte*, 4> expected_planes{};
+                    for (size_t i{}; i != samples_per_pixel; ++i)
+                    {
+                        actual_planes[i] = actual.data() + i * count * sample_size;
+                        expected_planes[i] = expected.data() + i * count * sample_size;
+                    }
+
+                    deinterleave(pixels.data(), count, samples_per_pixel, sample_size, actual_planes.data());
+                    deinterleave_scalar(pixels.data(), count, samples_per_pixel, sample_size, expected_planes.data());
+
+                    Assert::IsTrue(expected == actual);
+                }
+            }
+        }
+    }
+
+    TEST_METHOD(parse_ascii_samples_keeps_incomplete_number) // NOLINT
+    {
+        const std::string text{" 12\n345\t6"};
+        vector<uint16_t> samples(3);
+
+        const auto [consumed, sample_count, valid]{parse_ascii_samples(as_bytes(std::span{text}), samples, false)};
+
+        Assert::IsTrue(valid);
+        Assert::AreEqual(size_t{2}, sample_count);
+        Assert::AreEqual(text.size() - 1, consumed);
+        Assert::AreEqual(static_cast<uint16_t>(12), samples[0]);
+        Assert::AreEqual(static_cast<uint16_t>(345), samples[1]);
+    }
+
+    TEST_METHOD(parse_ascii_samples_rejects_invalid_text) // NOLINT
+    {
+        vector<uint16_t> samples(2);
+
+        for (const std::string text : {"1 x", "1 65536", "1 2a", "0065536 2"})
+        {
+            Assert::IsFalse(parse_ascii_samples(as_bytes(std::span{text}), samples, true).valid);
+        }
+    }
+
+    TEST_METHOD(parse_ascii_samples_accepts_leading_zeros) // NOLINT
+    {
+        const std::string text{"000255 0000000000000000065535 00 "};
+        vector<uint16_t> samples(3);
+
+        const auto [consumed, sample_count, valid]{parse_ascii_samples(as_bytes(std::span{text}), samples, true)};
+
+        Assert::IsTrue(valid);
+        Assert::AreEqual(size_t{3}, sample_count);
+        Assert::AreEqual(static_cast<uint16_t>(255), samples[0]);
+        Assert::AreEqual(static_cast<uint16_t>(65535), samples[1]);
+        Assert::AreEqual(static_cast<uint16_t>(0), samples[2]);
+    }
+
+    TEST_METHOD(parse_ascii_samples_matches_scalar) // NOLINT
+    {
+        std::mt19937 generator{42};
+        std::uniform_int_distribution<int> distribution{0, 0xFFFF};
+        constexpr std::array separators{" ", "\n", "\r\n", "\t ", "   "};
+
+        std::string text;
+        vector<uint16_t> expected(1000);
+        for (uint16_t& sample : expected)
+        {
+            sample = static_cast<uint16_t>(distribution(generator));
+            text += std::to_string(sample);
+            text += separators[sample % separators.size()];
+        }
+
+        vector<uint16_t> actual(expected.size());
+        vector<uint16_t> actual_scalar(expected.size());
+        const auto result{parse_ascii_samples(as_bytes(std::span{text}), actual, true)};
+        const auto result_scalar{parse_ascii_samples_scalar(as_bytes(std::span{text}), actual_scalar, true)};
+
+        Assert::IsTrue(result.valid);
+        Assert::AreEqual(expected.size(), result.sample_count);
+        Assert::AreEqual(result_scalar.consumed, result.consumed);
+        Assert::IsTrue(expected == actual);
+        Assert::IsTrue(expected == actual_scalar);
+    }
+
+    TEST_METHOD(parse_ascii_bits) // NOLINT
+    {
+        const std::string text{"10 1\n0x"};
+        vector<std::byte> samples(4);
+
+        const auto [consumed, sample_count, valid]{::parse_ascii_bits(as_bytes(std::span{text}), samples)};
+
+        Assert::IsTrue(valid);
+        Assert::AreEqual(size_t{4}, sample_count);
+        Assert::AreEqual(text.size() - 1, consumed);
+        const vector expected{std::byte{1}, std::byte{0}, std::byte{1}, std::byte{0}};
+        Assert::IsTrue(expected == samples);
+    }
+
+    TEST_METHOD(invert_bits) // NOLINT
+    {
+        for (size_t count{}; count != 40; ++count)
+        {
+            vector samples{create_test_samples(count, 8)};
+            vector expected{samples};
+            std::ranges::transform(expected, expected.begin(), [](const std::byte value) noexcept { return ~value; });
+
+            ::invert_bits(samples);
+
+            Assert::IsTrue(expected == samples);
+        }
+    }
+
+    TEST_METHOD(convert_float_to_little_endian) // NOLINT
+    {
+        for (size_t count{}; count != 20; ++count)
+        {
+            vector<float> expected(count);
+            std::iota(expected.begin(), expected.end(), -2.5F);
+
+            vector<float> samples(count);
+            std::ranges::transform(expected, samples.begin(), [](const float value) noexcept {
+                return std::bit_cast<float>(std::byteswap(std::bit_cast<uint32_t>(value)));
+            });
+
+            convert_to_little_endian(samples);
+
+            Assert::IsTrue(expected == samples);
+        }
+    }
+
+    TEST_METHOD(convert_to_little_endian_and_scale_matches_scalar) // NOLINT
+    {
+        for (const uint16_t max_value : {uint16_t{256}, uint16_t{1000}, uint16_t{4095}, uint16_t{40000}, uint16_t{65534}})
+        {
+            for (size_t count{}; count != 40; ++count)
+            {
+                vector actual{create_test_samples(count)};
+                vector expected{actual};
+
+                convert_to_little_endian_and_scale(actual, max_value);
+                convert_to_little_endian_and_scale_scalar(expected, max_value);
+
+                Assert::IsTrue(expected == actual);
+            }
+        }
+    }
+
+    TEST_METHOD(narrow_to_8_bit_rounds_to_nearest) // NOLINT
+    {
+        const vector<uint16_t> samples{0, std::byteswap(uint16_t{128}), std::byteswap(uint16_t{129}),
+                                       std::byteswap(uint16_t{385}), std::byteswap(uint16_t{386}), 0xFFFF};
+        vector<std::byte> destination(samples.size());
+
+        narrow_to_8_bit(std::as_bytes(std::span{samples}), 65535, destination.data());
+
+        const vector expected{std::byte{0}, std::byte{0}, std::byte{1}, std::byte{1}, std::byte{2}, std::byte{255}};
+        Assert::IsTrue(expected == destination);
+    }
+
+    TEST_METHOD(narrow_to_8_bit_matches_scalar) // NOLINT
+    {
+        for (const uint16_t max_value : {uint16_t{256}, uint16_t{1023}, uint16_t{4095}, uint16_t{40000}, uint16_t{65535}})
+        {
+            for (size_t count{}; count != 40; ++count)
+            {
+                const vector samples{create_test_samples(count)};
+                vector<std::byte> actual(count);
+                vector<std::byte> expected(count);
+
+                narrow_to_8_bit(std::as_bytes(std::span{samples}), max_value, actual.data());
+                narrow_to_8_bit_scalar(std::as_bytes(std::span{samples}), max_value, expected.data());
+
+                Assert::IsTrue(expected == actual);
+            }
+        }
+    }
+
+    TEST_METHOD(sample_converter_scales_8_bit_samples) // NOLINT
+    {
+        const sample_converter converter{8, 0, 100};
+        vector samples{std::byte{0}, std::byte{50}, std::byte{100}, std::byte{200}};
+
+        converter(samples);
+
+        const vector expected{std::byte{0}, std::byte{128}, std::byte{255}, std::byte{255}};
+        Assert::IsTrue(expected == samples);
+        Assert::AreEqual(uint16_t{128}, converter.convert(50));
+    }
+
+    TEST_METHOD(sample_converter_scales_16_bit_samples) // NOLINT
+    {
+        const sample_converter converter{16, 0, 1000};
+        vector<uint16_t> samples{0, std::byteswap(uint16_t{500}), std::byteswap(uint16_t{1000})};
+
+        converter(std::as_writable_bytes(std::span{samples}));
+
+        const vector<uint16_t> expected{0, 32768, 65535};
+        Assert::IsTrue(expected == samples);
+        Assert::AreEqual(uint16_t{65535}, converter.convert(1001));
+    }
+};
@@ -0,0 +1,127 @@
+// SPDX-FileCopyrightText: © 2026 Team CharLS
+// SPDX-License-Identifier: BSD-3-Clause
+
+#include "intellisense.hpp"
+#include "cpp_unit_test.hpp"
+
+import std;
+import <win.hpp>;
+import winrt_base;
+
+import test.hresults;
+import test.stream;
+import test.util;
+import stream_prefetcher;
+
+using std::vector;
+using namespace Microsoft::VisualStudio::CppUnitTestFramework;
+
+namespace {
+
+[[nodiscard]] vector<std::byte> create_test_data(const size_t size)
+{
+    vector<std::byte> data(size);
+    for (size_t i{}; i != size; ++i)
+    {
+        data[i] = static_cast<std::byte>(i * 7 + i / 251);
+    }
+
+    return data;
+}
+
+} // namespace
+
+
+TEST_CLASS(stream_prefetcher_test)
+{
+public:
+    TEST_METHOD(read_returns_data_in_order) // NOLINT
+    {
+        // Larger than the chunks to read and release chunks while the background thread reads.
+        const vector source{create_test_data(5 * 1024 * 1024 + 123)};
+        const auto stream{create_memory_stream(source)};
+        stream_prefetcher prefetcher{stream.get(), source.size()};
+
+        vector<std::byte> destination(source.size());
+        size_t position{};
+        for (size_t size{1}; position != destination.size(); size = size * 3 + 1)
+        {
+            const size_t read_size{std::min(size, destination.size() - position)};
+            Assert::AreEqual(read_size, prefetcher.read(destination.data() + position, read_size));
+            position += read_size;
+        }
+
+        Assert::IsTrue(source == destination);
+        std::byte extra;
+        Assert::AreEqual(size_t{}, prefetcher.read(&extra, 1));
+    }
+
+    TEST_METHOD(read_stops_at_size) // NOLINT
+    {
+        const vector source{create_test_data(100)};
+        const auto stream{create_memory_stream(source)};
+        stream_prefetcher prefetcher{stream.get(), 60};
+
+        vector<std::byte> destination(100);
+        Assert::AreEqual(size_t{60}, prefetcher.read(destination.data(), destination.size()));
+        Assert::IsTrue(std::equal(source.begin(), source.begin() + 60, destination.begin()));
+    }
+
+    TEST_METHOD(stream_shorter_than_size_throws) // NOLINT
+    {
+        const vector source{create_test_data(100)};
+        const auto stream{create_memory_stream(source)};
+        stream_prefetcher prefetcher{stream.get(), 200};
+
+        vector<std::byte> destination(150);
+        try
+        {
+            std::ignore = prefetcher.read(destination.data(), destination.size());
+            Assert::Fail();
+        }
+        catch (const winrt::hresult_error& error)
+        {
+            Assert::AreEqual(wincodec::error_stream_read, static_cast<HRESULT>(error.code()));
+        }
+    }
+
+    TEST_METHOD(skip_discards_data) // NOLINT
+    {
+        const vector source{create_test_data(3 * 1024 * 1024)};
+        const auto stream{create_memory_stream(source)};
+        stream_prefetcher prefetcher{stream.get(), source.size()};
+
+        Assert::AreEqual(size_t{2 * 1024 * 1024 + 5}, prefetcher.skip(2 * 1024 * 1024 + 5));
+        std::byte value;
+        Assert::AreEqual(size_t{1}, prefetcher.read(&value, 1));
+        Assert::IsTrue(source[2 * 1024 * 1024 + 5] == value);
+    }
+
+    TEST_METHOD(read_error_is_thrown) // NOLINT
+    {
+        const winrt::com_ptr<IStream> stream{winrt::make<test_stream>(true, 2)};
+        stream_prefetcher prefetcher{stream.get(), 100};
+
+        std::byte value;
+        try
+        {
+            std::ignore = prefetcher.read(&value, 1);
+            Assert::Fail();
+        }
+        catch (const winrt::hresult_error& error)
+        {
+            Assert::AreEqual(wincodec::error_stream_read, static_cast<HRESULT>(error.code()));
+        }
+    }
+
+    TEST_METHOD(destructor_stops_with_unread_data) // NOLINT
+    {
+        // The background thread waits for a free chunk when the destructor stops it.
+        const vector source{create_test_data(8 * 1024 * 1024)};
+        const auto stream{create_memory_stream(source)};
+        stream_prefetcher prefetcher{stream.get(), source.size()};
+
+        std::byte value;
+        Assert::AreEqual(size_t{1}, prefetcher.read(&value, 1));
+    }
+};
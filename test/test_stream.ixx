@@ -7,6 +7,7 @@ module;
 
 export module test.stream;
 
+import std;
 import <win.hpp>;
 
 import winrt_base;
@@ -89,3 +90,151 @@ export struct test_stream : winrt::implements<test_stream, IStream>
     bool fail_on_read_;
     int fail_on_seek_counter_;
 };
+
+// Reads from an existing stream, but cannot be cloned: the decoder and its frames have to share the stream.
+export struct non_clonable_stream : winrt::implements<non_clonable_stream, IStream>
+{
+    explicit non_clonable_stream(winrt::com_ptr<IStream> stream) noexcept : stream_{std::move(stream)}
+    {
+    }
+
+    HRESULT __stdcall Read(_Out_writes_bytes_to_(cb, *pcbRead) void* pv, _In_ ULONG cb,
+                           _Out_opt_ ULONG* pcbRead) noexcept override
+    {
+        return stream_->Read(pv, cb, pcbRead);
+    }
+
+    HRESULT __stdcall Write(_In_reads_bytes_(cb) const void* /*pv*/, [[maybe_unused]] _In_ ULONG cb,
+                            _Out_opt_ ULONG* /*pcbWritten*/) noexcept override
+    {
+        return error_fail;
+    }
+
+    HRESULT __stdcall Seek(const LARGE_INTEGER dlibMove, const DWORD dwOrigin,
+                           _Out_opt_ ULARGE_INTEGER* libNewPosition) noexcept override
+    {
+        return stream_->Seek(dlibMove, dwOrigin, libNewPosition);
+    }
+
+    HRESULT __stdcall SetSize(ULARGE_INTEGER /*libNewSize*/) noexcept override
+    {
+        return error_fail;
+    }
+
+    HRESULT __stdcall CopyTo(_In_ IStream*, ULARGE_INTEGER /*cb*/, _Out_opt_ ULARGE_INTEGER* /*pcbRead*/,
+                             _Out_opt_ ULARGE_INTEGER* /*pcbWritten*/) noexcept override
+    {
+        return error_fail;
+    }
+
+    HRESULT __stdcall Commit(DWORD /*grfCommitFlags*/) noexcept override
+    {
+        return error_fail;
+    }
+
+    HRESULT __stdcall Revert() noexcept override
+    {
+        return error_fail;
+    }
+
+    HRESULT __stdcall LockRegion(ULARGE_INTEGER /*libOffset*/, ULARGE_INTEGER /*cb*/, DWORD /*dwLockType*/) noexcept override
+    {
+        return error_fail;
+    }
+
+    HRESULT __stdcall UnlockRegion(ULARGE_INTEGER /*libOffset*/, ULARGE_INTEGER /*cb*/,
+                                   DWORD /*dwLockType*/) noexcept override
+    {
+        return error_fail;
+    }
+
+    HRESULT __stdcall Stat(__RPC__out STATSTG* pstatstg, const DWORD grfStatFlag) noexcept override
+    {
+        return stream_->Stat(pstatstg, grfStatFlag);
+    }
+
+    HRESULT __stdcall Clone(__RPC__deref_out_opt IStream**) noexcept override
+    {
+        return error_fail;
+    }
+
+private:
+    winrt::com_ptr<IStream> stream_;
+};
+
+// Reports the statistics of an existing stream with a different last write time, as a stream on a replaced file would.
+export struct touched_stream : winrt::implements<touched_stream, IStream>
+{
+    explicit touched_stream(winrt::com_ptr<IStream> stream) noexcept : stream_{std::move(stream)}
+    {
+    }
+
+    HRESULT __stdcall Read(_Out_writes_bytes_to_(cb, *pcbRead) void* pv, _In_ ULONG cb,
+                           _Out_opt_ ULONG* pcbRead) noexcept override
+    {
+        return stream_->Read(pv, cb, pcbRead);
+    }
+
+    HRESULT __stdcall Write(_In_reads_bytes_(cb) const void* /*pv*/, [[maybe_unused]] _In_ ULONG cb,
+                            _Out_opt_ ULONG* /*pcbWritten*/) noexcept override
+    {
+        return error_fail;
+    }
+
+    HRESULT __stdcall Seek(const LARGE_INTEGER dlibMove, const DWORD dwOrigin,
+                           _Out_opt_ ULARGE_INTEGER* libNewPosition) noexcept override
+    {
+        return stream_->Seek(dlibMove, dwOrigin, libNewPosition);
+    }
+
+    HRESULT __stdcall SetSize(ULARGE_INTEGER /*libNewSize*/) noexcept override
+    {
+        return error_fail;
+    }
+
+    HRESULT __stdcall CopyTo(_In_ IStream*, ULARGE_INTEGER /*cb*/, _Out_opt_ ULARGE_INTEGER* /*pcbRead*/,
+                             _Out_opt_ ULARGE_INTEGER* /*pcbWritten*/) noexcept override
+    {
+        return error_fail;
+    }
+
+    HRESULT __stdcall Commit(DWORD /*grfCommitFlags*/) noexcept override
+    {
+        return error_fail;
+    }
+
+    HRESULT __stdcall Revert() noexcept override
+    {
+        return error_fail;
+    }
+
+    HRESULT __stdcall LockRegion(ULARGE_INTEGER /*libOffset*/, ULARGE_INTEGER /*cb*/, DWORD /*dwLockType*/) noexcept override
+    {
+        return error_fail;
+    }
+
+    HRESULT __stdcall UnlockRegion(ULARGE_INTEGER /*libOffset*/, ULARGE_INTEGER /*cb*/,
+                                   DWORD /*dwLockType*/) noexcept override
+    {
+        return error_fail;
+    }
+
+    HRESULT __stdcall Stat(__RPC__out STATSTG* pstatstg, const DWORD grfStatFlag) noexcept override
+    {
+        const HRESULT result{stream_->Stat(pstatstg, grfStatFlag)};
+        if (SUCCEEDED(result))
+        {
+            ++pstatstg->mtime.dwLowDateTime;
+        }
+
+        return result;
+    }
+
+    HRESULT __stdcall Clone(__RPC__deref_out_opt IStream**) noexcept override
+    {
+        return error_fail;
+    }
+
+private:
+    winrt::com_ptr<IStream> stream_;
+};